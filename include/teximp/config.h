@@ -30,6 +30,7 @@
 
 #ifdef TEXIMP_ENABLE_EXR
 #define TEXIMP_ENABLE_EXR_BACKEND_OPENEXR
+#define TEXIMP_ENABLE_EXR_BACKEND_OPENEXR_CORE
 #endif
 
 #ifdef TEXIMP_ENABLE_JPEG
@@ -42,6 +43,7 @@
 
 #ifdef TEXIMP_ENABLE_PNG
 #define TEXIMP_ENABLE_PNG_BACKEND_LIBPNG
+#define TEXIMP_ENABLE_PNG_BACKEND_SPNG
 #endif
 
 #ifdef TEXIMP_ENABLE_TARGA
@@ -31,15 +31,24 @@
 #pragma warning(pop)
 #endif
 
+#include <map>
+#include <memory>
+#include <optional>
 #include <set>
 #include <variant>
 #include <vector>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 class FrameBuffer;
-class StdIStream;
+class IStream;
+class TiledInputFile;
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
 
+namespace teximp
+{
+class MemoryMappedFile;
+}
+
 namespace teximp::exr
 {
 class ExrOpenExrImporter : public TextureImporter
@@ -90,6 +99,10 @@ public:
         std::array<ChannelPair, 4> channels;
         gpufmt::ChannelMask channelMask = gpufmt::ChannelMask::None;
         Imf::PixelType pixelType;
+        // format negotiated with the texture allocator
+        gpufmt::Format format = gpufmt::Format::UNDEFINED;
+        // made of r, g, b and a channels, only these can be packed into unsigned float formats
+        bool color = false;
     };
 
     struct View
@@ -104,23 +117,60 @@ public:
         std::set<std::string> layerNames;
         std::vector<std::string> viewNames;
         std::vector<View> views;
-        std::map<std::string, AttributeVariant> attributes;
         int totalSubViews = 0;
     };
 
+    struct TileLevel
+    {
+        int levelX = 0;
+        int levelY = 0;
+        glm::ivec2 extent{0, 0};
+        glm::ivec2 tileCount{0, 0};
+    };
+
+    struct TileKey
+    {
+        int levelX = 0;
+        int levelY = 0;
+        int tileX = 0;
+        int tileY = 0;
+    };
+
+    ExrOpenExrImporter();
+    ExrOpenExrImporter(const ExrOpenExrImporter&) = delete;
+    ExrOpenExrImporter(ExrOpenExrImporter&&);
+    ~ExrOpenExrImporter() override;
+
+    ExrOpenExrImporter& operator=(const ExrOpenExrImporter&) = delete;
+    ExrOpenExrImporter& operator=(ExrOpenExrImporter&&);
+
     FileFormat fileFormat() const final;
 
     const std::span<const Part> parts() const { return mParts; }
 
+    // Attributes of a part's header. They're parsed the first time a part's attributes are requested, imports that
+    // never look at them don't pay for it.
+    const std::map<std::string, AttributeVariant>& attributes(size_t partIndex);
+
+    // Levels of a tiled image imported with TextureImportOptions::deferTileLoading. Mipmapped images have one level per
+    // mip with levelX == levelY, ripmapped images have every combination of x and y levels.
+    std::span<const TileLevel> tileLevels() const { return mTileLevels; }
+    glm::ivec2 tileSize() const { return mTileSize; }
+
+    // Decodes one tile of a deferred tiled image. Every sub view layout is allocated from tileAllocator as a single mip
+    // texture with the extent of the tile, tiles on the right and bottom edges can be smaller than tileSize().
+    // Not thread safe.
+    bool readTile(const TileKey& key, ITextureAllocator& tileAllocator);
+
 protected:
     bool checkSignature(std::istream& stream) final;
     void load(std::istream& stream, ITextureAllocator& textureAllocator, TextureImportOptions options) final;
 
-    void loadDeepImage(Imf::StdIStream& exrStream, ITextureAllocator& textureAllocator, TextureImportOptions options);
-    void loadImage(Imf::StdIStream& exrStream, ITextureAllocator& textureAllocator, TextureImportOptions options);
-    void loadMultiPartImage(Imf::StdIStream& exrStream, ITextureAllocator& textureAllocator,
+    void loadDeepImage(Imf::IStream& exrStream, ITextureAllocator& textureAllocator, TextureImportOptions options);
+    void loadImage(Imf::IStream& exrStream, ITextureAllocator& textureAllocator, TextureImportOptions options);
+    void loadMultiPartImage(Imf::IStream& exrStream, ITextureAllocator& textureAllocator,
                             TextureImportOptions options);
-    void loadTiledImage(Imf::StdIStream& exrStream, ITextureAllocator& textureAllocator, TextureImportOptions options);
+    void loadTiledImage(Imf::IStream& exrStream, ITextureAllocator& textureAllocator, TextureImportOptions options);
 
 private:
     struct TileProperties
@@ -136,13 +186,34 @@ private:
         glm::ivec2 displayWindowMax{0, 0};
         glm::ivec2 dataWindowMin{0, 0};
         glm::ivec2 dataWindowMax{0, 0};
+        // part of the data window that is allocated and decoded
+        glm::ivec2 regionMin{0, 0};
+        glm::ivec2 regionMax{0, 0};
         int mips = 1;
+
+        bool regionSpansDataWindowWidth() const
+        {
+            return regionMin.x == dataWindowMin.x && regionMax.x == dataWindowMax.x;
+        }
     };
 
+    // stream over the file's data that is independent of the import stream
+    std::unique_ptr<Imf::IStream> openExrStream() const;
+
+    static Properties readProperties(const Imf::Header& header);
+    void openDeferredTiles(const TextureImportOptions& options);
+    bool loadPreviewImage(Imf::IStream& exrStream, ITextureAllocator& textureAllocator,
+                          const TextureImportOptions& options);
+    bool applyRegion(Properties& properties, const std::optional<ImportRegion>& region);
+
     bool createTextureForLayout(ITextureAllocator& textureAllocator, int textureIndex,
                                 ExrOpenExrImporter::SubViewLayout& layout, const Properties& properties);
 
-    void extractAllLayouts(const Properties& properties, Part& part, ITextureAllocator& textureAllocator);
+    bool selectLayoutFormats(Part& part, bool allowPackedLayouts, ITextureAllocator& textureAllocator);
+
+    void extractAllLayouts(const Properties& properties, Part& part,
+                           const std::function<bool(std::string_view)>& channelFilter,
+                           ITextureAllocator& textureAllocator);
 
     int allocateTextures(const Properties& properties, Part& part, int textureIndexStart,
                          ITextureAllocator& textureAllocator);
@@ -152,6 +223,15 @@ private:
 
     std::vector<Part> mParts;
     std::set<size_t> mResolvedChannels;
+    std::vector<std::optional<std::map<std::string, AttributeVariant>>> mPartAttributes;
+
+    // the import's source data or the mapped file, empty when neither is available
+    std::span<const std::byte> mExrData;
+    std::unique_ptr<MemoryMappedFile> mMappedFile;
+    std::unique_ptr<Imf::IStream> mTileStream;
+    std::unique_ptr<Imf::TiledInputFile> mTiledInputFile;
+    std::vector<TileLevel> mTileLevels;
+    glm::ivec2 mTileSize{0, 0};
 };
 } // namespace teximp::exr
 
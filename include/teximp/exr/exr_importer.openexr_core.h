@@ -0,0 +1,78 @@
+#pragma once
+
+#include <teximp/teximp.h>
+
+#ifdef TEXIMP_ENABLE_EXR_BACKEND_OPENEXR_CORE
+
+#include <openexr.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace teximp::exr
+{
+// Exr importer built on OpenEXRCore's chunk API. Every scanline block and tile of every part is decoded as an
+// independent task straight into the allocated textures, so even single part scanline images use all threads.
+// Textures are created per layer like the OpenEXR importer, r, g, b and a channels of the same pixel type share a
+// texture and every other channel gets its own. Deep and subsampled images are not supported.
+class ExrOpenExrCoreImporter final : public TextureImporter
+{
+public:
+    struct TextureLayout
+    {
+        int partIndex = 0;
+        std::string layerName;
+        std::array<std::string, 4> channelNames;
+        gpufmt::ChannelMask channelMask = gpufmt::ChannelMask::None;
+        exr_pixel_type_t pixelType = EXR_PIXEL_HALF;
+        // format negotiated with the texture allocator
+        gpufmt::Format format = gpufmt::Format::UNDEFINED;
+        int textureIndex = -1;
+        // made of r, g, b and a channels
+        bool color = false;
+    };
+
+    ExrOpenExrCoreImporter() = default;
+    ExrOpenExrCoreImporter(const ExrOpenExrCoreImporter&) = delete;
+    ExrOpenExrCoreImporter(ExrOpenExrCoreImporter&&) = default;
+    virtual ~ExrOpenExrCoreImporter() = default;
+
+    ExrOpenExrCoreImporter& operator=(const ExrOpenExrCoreImporter&) = delete;
+    ExrOpenExrCoreImporter& operator=(ExrOpenExrCoreImporter&&) = default;
+
+    FileFormat fileFormat() const final;
+
+    // One entry per imported texture, in texture index order.
+    std::span<const TextureLayout> textureLayouts() const { return mTextureLayouts; }
+
+protected:
+    bool checkSignature(std::istream& stream) final;
+    void load(std::istream& stream, ITextureAllocator& textureAllocator, TextureImportOptions options) final;
+
+private:
+    struct PartProperties
+    {
+        exr_storage_t storage = EXR_STORAGE_SCANLINE;
+        glm::ivec2 dataWindowMin{0, 0};
+        glm::ivec2 extent{0, 0};
+        int mips = 1;
+        // lines per scanline block or the tile size
+        glm::ivec2 chunkSize{0, 0};
+        // texture layout and component every channel of the part decodes to, -1 for channels that aren't imported
+        std::vector<std::array<int, 2>> channelTargets;
+    };
+
+    void setErrorFromExr(exr_result_t result, TextureImportError error = TextureImportError::InvalidDataInImage);
+
+    bool readPartProperties(exr_const_context_t context, int partIndex,
+                            const std::function<bool(std::string_view)>& channelFilter, PartProperties& properties);
+    bool selectLayoutFormats(ITextureAllocator& textureAllocator);
+    bool decodeChunks(exr_const_context_t context, std::span<const PartProperties> partProperties,
+                      ITextureAllocator& textureAllocator, int threadCount);
+
+    std::vector<TextureLayout> mTextureLayouts;
+};
+} // namespace teximp::exr
+
+#endif // TEXIMP_ENABLE_EXR_BACKEND_OPENEXR_CORE
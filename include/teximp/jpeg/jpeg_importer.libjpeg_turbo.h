@@ -14,6 +14,12 @@ public:
     virtual FileFormat fileFormat() const final;
     virtual bool checkSignature(std::istream& stream) final;
     virtual void load(std::istream& stream, ITextureAllocator& textureAlloctor, TextureImportOptions options) final;
+
+private:
+    gpufmt::Format selectFormat(ITextureAllocator& textureAllocator, TextureImportOptions options, bool grayscale);
+    bool loadStreaming(std::istream& stream, ITextureAllocator& textureAllocator, TextureImportOptions options);
+    void loadYuvPlanes(void* handle, std::span<const uint8_t> imageData, int width, int height, int subsamp,
+                       ITextureAllocator& textureAllocator);
 };
 } // namespace teximp::jpeg
 
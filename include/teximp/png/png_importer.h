@@ -0,0 +1,32 @@
+#pragma once
+
+#include <teximp/teximp.h>
+
+#ifdef TEXIMP_ENABLE_PNG
+
+namespace teximp::png
+{
+// Format negotiation shared by the png backends so every backend hands the allocator the same choices.
+class PngImporter : public TextureImporter
+{
+public:
+    FileFormat fileFormat() const final;
+
+protected:
+    // Alpha comes from the color type or a tRNS chunk, which every backend expands to an alpha channel.
+    [[nodiscard]] static bool hasAlpha(int colorType, bool hasTransparencyChunk) noexcept;
+
+    gpufmt::Format selectFormat(ITextureAllocator& textureAllocator, int bitDepth, bool alphaNeeded, bool sRgb);
+    gpufmt::Format selectIndexFormat(ITextureAllocator& textureAllocator);
+    gpufmt::Format selectPaletteFormat(ITextureAllocator& textureAllocator, bool sRgb);
+};
+
+[[nodiscard]] constexpr bool isBgrFormat(gpufmt::Format format) noexcept
+{
+    return format == gpufmt::Format::B8G8R8A8_SRGB || format == gpufmt::Format::B8G8R8A8_UNORM ||
+           format == gpufmt::Format::B8G8R8X8_SRGB || format == gpufmt::Format::B8G8R8X8_UNORM ||
+           format == gpufmt::Format::B8G8R8_SRGB || format == gpufmt::Format::B8G8R8_UNORM;
+}
+} // namespace teximp::png
+
+#endif // TEXIMP_ENABLE_PNG
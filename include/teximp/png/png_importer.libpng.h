@@ -1,14 +1,25 @@
 #pragma once
 
-#include <teximp/teximp.h>
+#include <teximp/png/png_importer.h>
 
 #ifdef TEXIMP_ENABLE_PNG_BACKEND_LIBPNG
 
+#include <vector>
+
+struct png_struct_def;
+struct png_info_def;
+
 namespace teximp::png
 {
-class PngLibPngImporter final : public TextureImporter
+class PngLibPngImporter final : public PngImporter
 {
 public:
+    struct AnimationFrame
+    {
+        uint16_t delayNumerator = 0;
+        uint16_t delayDenominator = 100;
+    };
+
     PngLibPngImporter() = default;
     PngLibPngImporter(const PngLibPngImporter&) = delete;
     PngLibPngImporter(PngLibPngImporter&&) = default;
@@ -17,14 +28,22 @@ public:
     PngLibPngImporter& operator=(const PngLibPngImporter&) = delete;
     PngLibPngImporter& operator=(PngLibPngImporter&&) = default;
 
-    FileFormat fileFormat() const final;
-
     void setErrorMessageFromLibPng(const char* message);
 
+    std::span<const AnimationFrame> animationFrames() const { return mAnimationFrames; }
+    uint32_t animationPlayCount() const { return mAnimationPlayCount; }
+
 protected:
-    gpufmt::Format selectFormat(ITextureAllocator& textureAllocator, int bitDepth, bool alphaNeeded, bool sRgb);
     bool checkSignature(std::istream& stream) final;
     void load(std::istream& stream, ITextureAllocator& textureAllocator, TextureImportOptions options) final;
+
+private:
+    bool loadAnimation(std::istream& stream, ITextureAllocator& textureAllocator, TextureImportOptions options);
+    void readPalettizedImage(png_struct_def* pngRead, png_info_def* pngInfo, ITextureAllocator& textureAllocator,
+                             bool sRgb);
+
+    std::vector<AnimationFrame> mAnimationFrames;
+    uint32_t mAnimationPlayCount = 0;
 };
 } // namespace teximp::png
 
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <teximp/png/png_importer.h>
+
+#ifdef TEXIMP_ENABLE_PNG_BACKEND_SPNG
+
+struct spng_ctx;
+
+namespace teximp::png
+{
+// Png importer built on libspng. Produces the same formats as the libpng importer, animated pngs are imported as their
+// default image.
+class PngSpngImporter final : public PngImporter
+{
+public:
+    PngSpngImporter() = default;
+    PngSpngImporter(const PngSpngImporter&) = delete;
+    PngSpngImporter(PngSpngImporter&&) = default;
+    virtual ~PngSpngImporter() = default;
+
+    PngSpngImporter& operator=(const PngSpngImporter&) = delete;
+    PngSpngImporter& operator=(PngSpngImporter&&) = default;
+
+protected:
+    bool checkSignature(std::istream& stream) final;
+    void load(std::istream& stream, ITextureAllocator& textureAllocator, TextureImportOptions options) final;
+
+private:
+    void setErrorFromSpng(int errorCode);
+    void readPalettizedImage(spng_ctx* context, ITextureAllocator& textureAllocator, uint32_t width, uint32_t height,
+                             int bitDepth, bool sRgb);
+};
+} // namespace teximp::png
+
+#endif // TEXIMP_ENABLE_PNG_BACKEND_SPNG
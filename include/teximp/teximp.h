@@ -9,6 +9,7 @@
 #include <functional>
 #include <istream>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string_view>
 
@@ -80,6 +81,14 @@ enum class ExrImporterBackend
 #ifdef TEXIMP_ENABLE_EXR_BACKEND_OPENEXR
     OpenExr,
 #endif
+
+#ifdef TEXIMP_ENABLE_EXR_BACKEND_OPENEXR_CORE
+    // Imports fail with TextureImportError::UnsupportedFeature when TextureImportOptions::region or deferTileLoading
+    // is set. TextureImportOptions::thumbnailSize is ignored, the full image is imported and importThumbnail
+    // downsamples it afterwards.
+    OpenExrCore,
+#endif
+
     Default = 0
 };
 #endif
@@ -110,6 +119,11 @@ enum class PngImporterBackend
 #ifdef TEXIMP_ENABLE_PNG_BACKEND_LIBPNG
     LibPng,
 #endif
+
+#ifdef TEXIMP_ENABLE_PNG_BACKEND_SPNG
+    Spng,
+#endif
+
     Default = 0
 };
 #endif
@@ -171,10 +185,62 @@ constexpr std::array kTiffExtensions = std::to_array<std::string_view>({"tiff",
 constexpr int kMaxTextureWidth = 16384;
 constexpr int kMaxTextureHeight = 16384;
 
+// Rectangle in pixels, relative to the top left of the image.
+struct ImportRegion
+{
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
 struct TextureImportOptions
 {
     bool padRgbWithAlpha = true;
     bool assumeSrgb = true;
+    // Import palettized images as an 8 bit index texture (texture 0) and a 1D palette texture (texture 1) instead of
+    // expanding the palette during decode. Currently supported by the png importer.
+    bool preservePalette = false;
+    // Import every frame of an animated image into the array slices of a single texture. Currently supported by the
+    // png importer (APNG).
+    bool importAnimationFrames = false;
+    // Maximum number of threads an importer may use for independent decode work. 0 uses
+    // std::thread::hardware_concurrency(). The exr importer also passes it to OpenEXR for line buffer and tile
+    // decompression, growing OpenEXR's global thread pool when it is smaller.
+    int threadCount = 0;
+    // The file comes from a trusted pipeline. Integrity checks that only guard against corrupt or malicious files
+    // (checksums, end of file bookkeeping) are skipped, the decoded image is the same either way. Malformed files may
+    // import garbage instead of reporting an error.
+    bool trustedSource = false;
+    // Import a full mip chain instead of only the base level. Currently supported by the jpeg importer, which decodes
+    // the levels down to 1/8 scale directly from the DCT coefficients.
+    bool generateMips = false;
+    // Number of mip levels to drop from the top of the image, the imported base level is 1/2^reduceLevels of the full
+    // size. Currently supported by the jpeg importer.
+    int reduceLevels = 0;
+    // Import the Y, Cb and Cr planes of YCbCr images as separate 8 bit textures at their native subsampling instead of
+    // converting to RGB. Currently supported by the jpeg importer, grayscale images only produce the Y plane. The Y
+    // plane has the image's extent and the chroma planes are rounded up, the import fails when reduceLevels,
+    // generateMips or thumbnailSize is also set.
+    bool yuvPlanarOutput = false;
+    // Decode while reading the file through a small fixed buffer instead of loading the whole file first. Currently
+    // supported by the jpeg importer for reduceLevels up to 3, it then skips the multithreaded decode paths.
+    bool streamingDecode = false;
+    // Called with the full name of every channel (e.g. "beauty.R", "depth.Z"). Channels it returns false for are not
+    // allocated or decoded, an empty filter imports every channel. Currently supported by the exr importer.
+    std::function<bool(std::string_view)> channelFilter;
+    // Only allocate and decode this part of the image, it's clipped to the image bounds. Currently supported by the
+    // OpenEXR exr backend, where it's relative to the data window and limits tiled images to their base level.
+    std::optional<ImportRegion> region;
+    // Only read the header of tiled images and keep the file open, no textures are allocated by the import. Tiles are
+    // then decoded one at a time through the importer's tile interface. Currently supported by the OpenEXR exr backend,
+    // see ExrOpenExrImporter::readTile.
+    bool deferTileLoading = false;
+    // Largest width or height the import is going to be shown at, 0 imports the full image. Importers then take the
+    // cheapest route to the smallest image whose larger side is still at least this size, like an embedded preview, a
+    // stored mip or reduced resolution subfile, or a scaled decode. Currently supported by the dds, exr (OpenEXR
+    // backend), jpeg, ktx, targa and tiff importers, see importThumbnail.
+    int thumbnailSize = 0;
 };
 
 enum class TextureImportStatus
@@ -341,6 +407,11 @@ protected:
     TextureImportError mError = TextureImportError::None;
     std::string mErrorMessage;
     ITextureAllocator* mTextureAllocator = nullptr;
+    // options the import was started with, already set when checkSignature is called
+    TextureImportOptions mOptions;
+    // memory the import stream reads from when the import was started from a span, already set when checkSignature is
+    // called. Importers can read it directly instead of copying through the stream.
+    std::span<const std::byte> mSourceData;
 };
 
 struct TextureImportResult
@@ -357,6 +428,22 @@ std::unique_ptr<TextureImporter> importTexture(const std::filesystem::path& file
                                                ITextureAllocator& textureAllocator, TextureImportOptions options = {},
                                                PreferredBackends preferredBackends = {});
 
+// Imports from a file already in memory. data has to stay valid as long as the importer is used.
+[[nodiscard]] TextureImportResult importTexture(std::span<const std::byte> data, TextureImportOptions options = {},
+                                                PreferredBackends preferredBackends = {});
+
+std::unique_ptr<TextureImporter> importTexture(std::span<const std::byte> data, ITextureAllocator& textureAllocator,
+                                               TextureImportOptions options = {},
+                                               PreferredBackends preferredBackends = {});
+
+// Imports a single 2D texture whose width and height are at most maxDimension. The import runs with
+// TextureImportOptions::thumbnailSize set, so importers skip as much of the full image as their format allows. Images
+// that are still too large are box filtered down afterwards, block compressed images only use their closest mip.
+// Images that are already small enough keep their size. Only the first texture of an import is used.
+[[nodiscard]] TextureImportResult importThumbnail(const std::filesystem::path& filePath, int maxDimension,
+                                                  TextureImportOptions options = {},
+                                                  PreferredBackends preferredBackends = {});
+
 template<class T>
 [[nodiscard]] constexpr std::span<T> castWritableBytes(std::span<std::byte> bytes) noexcept
 {
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TEXIMP_CMYK_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXIMP_CMYK_SSE2
+#endif
+
+namespace teximp
+{
+// Converts cmyk pixels to rgba in place, r = (max - c) * (max - k) / max rounded to nearest and alpha is opaque. The
+// kernels use the widest instruction set the library is compiled for, every path gives bit identical results.
+
+[[nodiscard]] inline uint8_t cmykMultiply8(uint32_t inverseColor, uint32_t inverseBlack) noexcept
+{
+    // exact round(x / 255) for x <= 255 * 255
+    const uint32_t product = inverseColor * inverseBlack + 128u;
+    return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+}
+
+[[nodiscard]] inline uint16_t cmykMultiply16(uint32_t inverseColor, uint32_t inverseBlack) noexcept
+{
+    // exact round(x / 65535) for x <= 65535 * 65535
+    const uint32_t product = inverseColor * inverseBlack + 32768u;
+    return static_cast<uint16_t>((product + (product >> 16)) >> 16);
+}
+
+inline void convertCmyk8ToRgba8Scalar(uint8_t* pixels, size_t pixelCount) noexcept
+{
+    for(size_t i = 0; i < pixelCount; ++i, pixels += 4)
+    {
+        const uint32_t inverseBlack = 255u - pixels[3];
+
+        pixels[0] = cmykMultiply8(255u - pixels[0], inverseBlack);
+        pixels[1] = cmykMultiply8(255u - pixels[1], inverseBlack);
+        pixels[2] = cmykMultiply8(255u - pixels[2], inverseBlack);
+        pixels[3] = 255u;
+    }
+}
+
+inline void convertCmyk16ToRgba16Scalar(uint16_t* pixels, size_t pixelCount) noexcept
+{
+    for(size_t i = 0; i < pixelCount; ++i, pixels += 4)
+    {
+        const uint32_t inverseBlack = 65535u - pixels[3];
+
+        pixels[0] = cmykMultiply16(65535u - pixels[0], inverseBlack);
+        pixels[1] = cmykMultiply16(65535u - pixels[1], inverseBlack);
+        pixels[2] = cmykMultiply16(65535u - pixels[2], inverseBlack);
+        pixels[3] = 65535u;
+    }
+}
+
+#ifdef TEXIMP_CMYK_SSE2
+// 8 16 bit components, 2 pixels
+[[nodiscard]] inline __m128i cmykMultiply8(__m128i inverseCmyk) noexcept
+{
+    const __m128i inverseBlack =
+        _mm_shufflehi_epi16(_mm_shufflelo_epi16(inverseCmyk, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i product = _mm_add_epi16(_mm_mullo_epi16(inverseCmyk, inverseBlack), _mm_set1_epi16(128));
+
+    return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+}
+
+// 4 32 bit products, packed to 16 bits with unsigned range through signed saturation
+[[nodiscard]] inline __m128i cmykRound16(__m128i product) noexcept
+{
+    product = _mm_add_epi32(product, _mm_set1_epi32(32768));
+    product = _mm_srli_epi32(_mm_add_epi32(product, _mm_srli_epi32(product, 16)), 16);
+
+    return _mm_sub_epi32(product, _mm_set1_epi32(32768));
+}
+
+// 8 16 bit components, 2 pixels
+[[nodiscard]] inline __m128i cmykMultiply16(__m128i inverseCmyk) noexcept
+{
+    const __m128i inverseBlack =
+        _mm_shufflehi_epi16(_mm_shufflelo_epi16(inverseCmyk, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i productLow = _mm_mullo_epi16(inverseCmyk, inverseBlack);
+    const __m128i productHigh = _mm_mulhi_epu16(inverseCmyk, inverseBlack);
+
+    const __m128i rounded = _mm_packs_epi32(cmykRound16(_mm_unpacklo_epi16(productLow, productHigh)),
+                                            cmykRound16(_mm_unpackhi_epi16(productLow, productHigh)));
+
+    return _mm_xor_si128(rounded, _mm_set1_epi16(static_cast<short>(0x8000)));
+}
+#endif
+
+#ifdef TEXIMP_CMYK_AVX2
+[[nodiscard]] inline __m256i cmykMultiply8(__m256i inverseCmyk) noexcept
+{
+    const __m256i inverseBlack =
+        _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(inverseCmyk, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(inverseCmyk, inverseBlack), _mm256_set1_epi16(128));
+
+    return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+}
+
+[[nodiscard]] inline __m256i cmykRound16(__m256i product) noexcept
+{
+    product = _mm256_add_epi32(product, _mm256_set1_epi32(32768));
+
+    return _mm256_srli_epi32(_mm256_add_epi32(product, _mm256_srli_epi32(product, 16)), 16);
+}
+
+[[nodiscard]] inline __m256i cmykMultiply16(__m256i inverseCmyk) noexcept
+{
+    const __m256i inverseBlack =
+        _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(inverseCmyk, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m256i productLow = _mm256_mullo_epi16(inverseCmyk, inverseBlack);
+    const __m256i productHigh = _mm256_mulhi_epu16(inverseCmyk, inverseBlack);
+
+    // unpacking and packing both work within 128 bit lanes, so the pixel order is kept
+    return _mm256_packus_epi32(cmykRound16(_mm256_unpacklo_epi16(productLow, productHigh)),
+                               cmykRound16(_mm256_unpackhi_epi16(productLow, productHigh)));
+}
+#endif
+
+inline void convertCmyk8ToRgba8(std::span<std::byte> data) noexcept
+{
+    uint8_t* pixels = reinterpret_cast<uint8_t*>(data.data());
+    size_t pixelCount = data.size() / 4;
+
+#ifdef TEXIMP_CMYK_AVX2
+    const __m256i ones256 = _mm256_set1_epi8(-1);
+    const __m256i alpha256 = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+
+    for(; pixelCount >= 8; pixelCount -= 8, pixels += 32)
+    {
+        const __m256i inverseCmyk =
+            _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels)), ones256);
+        const __m256i low = cmykMultiply8(_mm256_unpacklo_epi8(inverseCmyk, _mm256_setzero_si256()));
+        const __m256i high = cmykMultiply8(_mm256_unpackhi_epi8(inverseCmyk, _mm256_setzero_si256()));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels),
+                            _mm256_or_si256(_mm256_packus_epi16(low, high), alpha256));
+    }
+#endif
+
+#ifdef TEXIMP_CMYK_SSE2
+    const __m128i ones = _mm_set1_epi8(-1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+
+    for(; pixelCount >= 4; pixelCount -= 4, pixels += 16)
+    {
+        const __m128i inverseCmyk = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels)), ones);
+        const __m128i low = cmykMultiply8(_mm_unpacklo_epi8(inverseCmyk, _mm_setzero_si128()));
+        const __m128i high = cmykMultiply8(_mm_unpackhi_epi8(inverseCmyk, _mm_setzero_si128()));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), _mm_or_si128(_mm_packus_epi16(low, high), alpha));
+    }
+#endif
+
+    convertCmyk8ToRgba8Scalar(pixels, pixelCount);
+}
+
+inline void convertCmyk16ToRgba16(std::span<std::byte> data) noexcept
+{
+    uint8_t* pixels = reinterpret_cast<uint8_t*>(data.data());
+    size_t pixelCount = data.size() / 8;
+
+#ifdef TEXIMP_CMYK_AVX2
+    const __m256i ones256 = _mm256_set1_epi8(-1);
+    const __m256i alpha256 = _mm256_set1_epi64x(static_cast<long long>(0xffff000000000000ull));
+
+    for(; pixelCount >= 4; pixelCount -= 4, pixels += 32)
+    {
+        const __m256i inverseCmyk =
+            _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels)), ones256);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels), _mm256_or_si256(cmykMultiply16(inverseCmyk), alpha256));
+    }
+#endif
+
+#ifdef TEXIMP_CMYK_SSE2
+    const __m128i ones = _mm_set1_epi8(-1);
+    const __m128i alpha = _mm_set1_epi64x(static_cast<long long>(0xffff000000000000ull));
+
+    for(; pixelCount >= 2; pixelCount -= 2, pixels += 16)
+    {
+        const __m128i inverseCmyk = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels)), ones);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), _mm_or_si128(cmykMultiply16(inverseCmyk), alpha));
+    }
+#endif
+
+    // surfaces are only guaranteed to be byte aligned
+    for(; pixelCount > 0; --pixelCount, pixels += 8)
+    {
+        uint16_t pixel[4];
+        std::memcpy(pixel, pixels, sizeof(pixel));
+        convertCmyk16ToRgba16Scalar(pixel, 1);
+        std::memcpy(pixels, pixel, sizeof(pixel));
+    }
+}
+} // namespace teximp
@@ -9,6 +9,8 @@
 #include <gpufmt/traits.h>
 #include <gpufmt/utility.h>
 
+#include "utilities.h"
+
 #include <bitset>
 #include <format>
 
@@ -62,7 +64,7 @@ cputex::TextureDimension getTextureDimension(const dds::DDS_HEADER& header, cons
 }
 
 void DdsTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAllocator,
-                             TextureImportOptions /*options*/)
+                             TextureImportOptions options)
 {
     stream.read(reinterpret_cast<char*>(&mHeader), sizeof(dds::DDS_HEADER));
 
@@ -199,13 +201,20 @@ void DdsTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAll
     uint32_t faces = (mHeader.caps2 & dds::DDSCAPS2_CUBEMAP) ? 6u : 1u;
     uint32_t depthCount = (mHeader.caps2 & dds::DDSCAPS2_VOLUME) ? mHeader.depth : 1u;
 
+    const cputex::Extent fullExtent{mHeader.width, mHeader.height, depthCount};
+
+    // thumbnails start at the smallest stored mip that still covers them, the larger mips are skipped
+    const uint32_t firstMip = static_cast<uint32_t>(
+        calculateThumbnailLevel(static_cast<int>(mHeader.width), static_cast<int>(mHeader.height),
+                                options.thumbnailSize, static_cast<int>(std::max(mips, 1u))));
+
     textureAllocator.preAllocation(1);
 
     cputex::TextureParams params;
     params.dimension = getTextureDimension(mHeader, mHeader10);
-    params.extent = {mHeader.width, mHeader.height, depthCount};
+    params.extent = cputex::calculateMipExtent(fullExtent, firstMip);
     params.faces = faces;
-    params.mips = mips;
+    params.mips = mips - firstMip;
     params.arraySize = std::max(mHeader10.arraySize, 1u);
     params.format = srcFormat;
 
@@ -219,19 +228,25 @@ void DdsTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAll
 
     const gpufmt::FormatInfo& formatInfo = gpufmt::formatInfo(params.format);
 
-    auto textureDataPos = stream.tellg();
-    stream.seekg(0, std::ios_base::end);
-    auto endPos = stream.tellg();
-    stream.seekg(textureDataPos);
-
-    const std::ptrdiff_t textureDataByteSize = endPos - textureDataPos;
+    // only used to report how much data was left when the file ends early
+    std::ptrdiff_t textureDataByteSize = 0;
     std::ptrdiff_t bytesRead = 0;
 
+    if(!options.trustedSource)
+    {
+        auto textureDataPos = stream.tellg();
+        stream.seekg(0, std::ios_base::end);
+        auto endPos = stream.tellg();
+        stream.seekg(textureDataPos);
+
+        textureDataByteSize = endPos - textureDataPos;
+    }
+
     for(cputex::CountType slice = 0; slice < params.arraySize; ++slice)
     {
         for(cputex::CountType face = 0; face < params.faces; ++face)
         {
-            for(cputex::CountType mip = 0; mip < params.mips; ++mip)
+            for(cputex::CountType mip = 0; mip < mips; ++mip)
             {
                 if(params.dimension == cputex::TextureDimension::TextureCube &&
                    (mHeader.caps2 & dds::DDS_CUBEMAP_ALLFACES))
@@ -244,16 +259,26 @@ void DdsTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAll
                     else if(face == 5 && (mHeader.caps2 & dds::DDS_CUBEMAP_NEGATIVEZ) == 0) { continue; }
                 }
 
-                std::span<std::byte> surface = textureAllocator.accessTextureData(
-                    0, MipSurfaceKey{.arraySlice = (int16_t)slice, .face = (int8_t)face, .mip = (int8_t)mip});
-
-                const cputex::Extent mipExtent = cputex::calculateMipExtent(params.extent, mip);
+                const cputex::Extent mipExtent = cputex::calculateMipExtent(fullExtent, mip);
                 cputex::Extent mipBlockExtent = mipExtent / formatInfo.blockExtent;
 
                 const auto expectedSurfaceByteSize = ((mipExtent.x + (formatInfo.blockExtent.x - 1)) / formatInfo.blockExtent.x) *
                     ((mipExtent.y + (formatInfo.blockExtent.y - 1)) / formatInfo.blockExtent.y) *
                     formatInfo.blockByteSize * mipExtent.z;
 
+                if(mip < firstMip)
+                {
+                    stream.seekg(expectedSurfaceByteSize, std::ios_base::cur);
+
+                    if(!options.trustedSource) { bytesRead += expectedSurfaceByteSize; }
+
+                    continue;
+                }
+
+                const MipSurfaceKey surfaceKey{
+                    .arraySlice = (int16_t)slice, .face = (int8_t)face, .mip = (int8_t)(mip - firstMip)};
+                std::span<std::byte> surface = textureAllocator.accessTextureData(0, surfaceKey);
+
                 if(expectedSurfaceByteSize > surface.size_bytes())
                 {
                     setError(TextureImportError::Unknown);
@@ -270,6 +295,14 @@ void DdsTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAll
                         mipExtent.x < formatInfo.blockExtent.x &&
                         mipExtent.y < formatInfo.blockExtent.y))
                     {
+                        if(options.trustedSource)
+                        {
+                            setError(TextureImportError::NotEnoughData,
+                                     std::format("Prematurely reached the end of the file while reading slice {}, face {}, mip {}.",
+                                                 slice, face, mip));
+                            return;
+                        }
+
                         const std::ptrdiff_t bytesRemaining = textureDataByteSize - bytesRead;
 
                         setError(TextureImportError::NotEnoughData,
@@ -280,7 +313,7 @@ void DdsTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAll
                     return;
                 }
 
-                bytesRead += expectedSurfaceByteSize;
+                if(!options.trustedSource) { bytesRead += expectedSurfaceByteSize; }
             }
         }
     }
@@ -8,6 +8,7 @@
 #pragma warning(disable :4100) // C4100 : 'version' : unreferenced formal parameter
 #endif
 
+#include <OpenEXR/IexBaseExc.h>
 #include <OpenEXR/ImfChannelList.h>
 #include <OpenEXR/ImfChannelListAttribute.h>
 #include <OpenEXR/ImfCompressionAttribute.h>
@@ -23,6 +24,7 @@
 #include <OpenEXR/ImfPreviewImageAttribute.h>
 #include <OpenEXR/ImfStandardAttributes.h>
 #include <OpenEXR/ImfTestFile.h>
+#include <OpenEXR/ImfThreading.h>
 #include <OpenEXR/ImfTileDescriptionAttribute.h>
 #include <OpenEXR/ImfTiledInputFile.h>
 #include <OpenEXR/ImfVersion.h>
@@ -31,13 +33,18 @@
 #pragma warning(pop)
 #endif
 
+#include "memory_mapped_file.h"
 #include "utilities.h"
 
 #include <cputex/utility.h>
 #include <errno.h>
 
+#include <atomic>
+#include <bit>
 #include <bitset>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 
@@ -103,6 +110,56 @@ private:
     std::istream* mStream = nullptr;
 };
 
+// Reads from memory that outlives the stream, either a span import or a mapped file. OpenEXR uses readMemoryMapped to
+// decompress chunks straight from it instead of copying them into its own buffers first.
+class MemoryIStream final : public Imf::IStream
+{
+public:
+    MemoryIStream(std::span<const std::byte> data, const char fileName[])
+        : Imf::IStream(fileName)
+        , mData(data)
+    {}
+
+    ~MemoryIStream() final = default;
+
+    bool isMemoryMapped() const final { return true; }
+
+    char* readMemoryMapped(int n) final
+    {
+        checkRange(n);
+
+        // OpenEXR only reads through the returned pointer
+        char* data = const_cast<char*>(reinterpret_cast<const char*>(mData.data() + mPosition));
+        mPosition += n;
+        return data;
+    }
+
+    bool read(char c[], int n) final
+    {
+        checkRange(n);
+
+        std::memcpy(c, mData.data() + mPosition, n);
+        mPosition += n;
+        return mPosition < mData.size();
+    }
+
+    uint64_t tellg() final { return mPosition; }
+
+    void seekg(uint64_t pos) final { mPosition = pos; }
+
+private:
+    void checkRange(int n) const
+    {
+        if(n < 0 || mPosition > mData.size() || static_cast<uint64_t>(n) > mData.size() - mPosition)
+        {
+            throw IEX_NAMESPACE::InputExc("Unexpected end of file.");
+        }
+    }
+
+    std::span<const std::byte> mData;
+    uint64_t mPosition = 0;
+};
+
 class StdStringStream final : public OStream
 {
 public:
@@ -136,6 +193,7 @@ struct ChannelPtrPair
 };
 
 void assignChannelsToLayouts(const Imf::ChannelList& channelList, const std::string& layerName,
+                             const std::function<bool(std::string_view)>& channelFilter,
                              std::vector<ExrOpenExrImporter::SubViewLayout>& layouts)
 {
     static constexpr std::array<std::string_view, 4> colorNames = {"r", "g", "b", "a"};
@@ -206,6 +264,9 @@ void assignChannelsToLayouts(const Imf::ChannelList& channelList, const std::str
     {
         std::string_view nameView{channelItr.name(), std::strlen(channelItr.name())};
 
+        // filtered channels never make it into a layout, so they're not allocated or added to a frame buffer
+        if(channelFilter && !channelFilter(nameView)) { continue; }
+
         std::string_view channelName = nameView.substr((!layerName.empty()) ? layerName.size() + 1 : 0);
 
         // colors
@@ -240,7 +301,11 @@ void assignChannelsToLayouts(const Imf::ChannelList& channelList, const std::str
 
     for(ExrOpenExrImporter::SubViewLayout& layout : colorLayouts)
     {
-        if(layout.channelMask != gpufmt::ChannelMask::None) { layouts.emplace_back(std::move(layout)); }
+        if(layout.channelMask != gpufmt::ChannelMask::None)
+        {
+            layout.color = true;
+            layouts.emplace_back(std::move(layout));
+        }
     }
 
     for(ExrOpenExrImporter::SubViewLayout& layout : positionLayouts)
@@ -305,11 +370,116 @@ gpufmt::Format getLayoutFormat(const ExrOpenExrImporter::SubViewLayout& layout)
     return gpufmt::Format::UNDEFINED;
 }
 
+// OpenEXR decompresses line buffers and tiles on its global thread pool, the per file thread count only sets how many
+// buffers are kept in flight. The pool is grown to the requested size but never shrunk since other imports may be using
+// it.
+int prepareExrThreadCount(int requestedThreadCount)
+{
+    const int threadCount = resolveThreadCount(requestedThreadCount);
+
+    // a thread count of 0 makes OpenEXR decompress on the calling thread
+    if(threadCount <= 1) { return 0; }
+
+    static std::mutex globalThreadCountMutex;
+    std::scoped_lock lock{globalThreadCountMutex};
+
+    if(Imf::globalThreadCount() < threadCount) { Imf::setGlobalThreadCount(threadCount); }
+
+    return threadCount;
+}
+
+[[nodiscard]] constexpr bool isPackedFloatFormat(gpufmt::Format format) noexcept
+{
+    return format == gpufmt::Format::B10G11R11_UFLOAT_PACK32 || format == gpufmt::Format::E5B9G9R9_UFLOAT_PACK32;
+}
+
+// Format OpenEXR writes the layout's channels in. OpenEXR converts between half and float itself, packed formats are
+// decoded to float and packed afterwards.
+gpufmt::Format getDecodeFormat(const ExrOpenExrImporter::SubViewLayout& layout)
+{
+    if(layout.format == gpufmt::Format::UNDEFINED) { return getLayoutFormat(layout); }
+    else if(isPackedFloatFormat(layout.format)) { return gpufmt::Format::R32G32B32_SFLOAT; }
+    else { return layout.format; }
+}
+
+bool hasPackedLayout(const ExrOpenExrImporter::Part& part)
+{
+    for(const ExrOpenExrImporter::View& view : part.views)
+    {
+        for(const ExrOpenExrImporter::SubViewLayout& subViewLayout : view.subViewLayouts)
+        {
+            if(isPackedFloatFormat(subViewLayout.format)) { return true; }
+        }
+    }
+
+    return false;
+}
+
+// Float to unsigned float with a 5 bit exponent, rounded to nearest. Negative values and NaN become 0, values above
+// the largest representable one are clamped. Branch free so the packing loops can be vectorized.
+template<int MantissaBits>
+[[nodiscard]] inline uint32_t floatToUFloat(float value) noexcept
+{
+    constexpr uint32_t shift = 23u - MantissaBits;
+    constexpr uint32_t maxValue = ((0x1Eu << MantissaBits) | ((1u << MantissaBits) - 1u)) << shift;
+    constexpr uint32_t minNormal = 0x38800000u; // 2^-14
+
+    // clamp in float, NaN compares false and turns into 0
+    const float clamped = (value > 0.0f) ? std::min(value, std::bit_cast<float>(maxValue + 0x38000000u)) : 0.0f;
+    uint32_t bits = std::bit_cast<uint32_t>(clamped);
+
+    // rebias the exponent from 127 to 15, denormals are shifted into place with their implicit bit
+    const uint32_t exponent = bits >> 23u;
+    const uint32_t denormalShift = std::min(113u - std::min(exponent, 113u), 24u);
+    const uint32_t denormal = (0x800000u | (bits & 0x7FFFFFu)) >> denormalShift;
+    bits = (bits < minNormal) ? denormal : bits - 0x38000000u;
+
+    return ((bits + ((1u << (shift - 1u)) - 1u) + ((bits >> shift) & 1u)) >> shift) & ((1u << (MantissaBits + 5)) - 1u);
+}
+
+void packB10G11R11(std::span<const float> rgb, std::span<uint32_t> packed)
+{
+    for(size_t i = 0; i < packed.size(); ++i)
+    {
+        packed[i] = floatToUFloat<6>(rgb[i * 3]) | (floatToUFloat<6>(rgb[i * 3 + 1]) << 11u) |
+                    (floatToUFloat<5>(rgb[i * 3 + 2]) << 22u);
+    }
+}
+
+void packE5B9G9R9(std::span<const float> rgb, std::span<uint32_t> packed)
+{
+    constexpr float maxValue = float(0x1FF << 7);
+    constexpr float minValue = 1.0f / float(1 << 16);
+
+    for(size_t i = 0; i < packed.size(); ++i)
+    {
+        // NaN compares false and turns into 0
+        const float r = (rgb[i * 3] > 0.0f) ? std::min(rgb[i * 3], maxValue) : 0.0f;
+        const float g = (rgb[i * 3 + 1] > 0.0f) ? std::min(rgb[i * 3 + 1], maxValue) : 0.0f;
+        const float b = (rgb[i * 3 + 2] > 0.0f) ? std::min(rgb[i * 3 + 2], maxValue) : 0.0f;
+
+        // round the largest channel up to 9 bits of mantissa to find the shared exponent
+        const uint32_t maxBits = std::bit_cast<uint32_t>(std::max(std::max(r, std::max(g, b)), minValue)) + 0x4000u;
+        const uint32_t exponent = maxBits >> 23u;
+        const float scale = std::bit_cast<float>(0x83000000u - (exponent << 23u));
+
+        packed[i] = static_cast<uint32_t>(r * scale + 0.5f) | (static_cast<uint32_t>(g * scale + 0.5f) << 9u) |
+                    (static_cast<uint32_t>(b * scale + 0.5f) << 18u) | ((exponent - 0x6Fu) << 27u);
+    }
+}
+
 int fillFrameBuffer(Imf::FrameBuffer& frameBuffer, glm::ivec2 min, const ExrOpenExrImporter::SubViewLayout& layout,
                     const cputex::Extent& textureExtent, std::span<std::byte> textureData)
 {
-    const gpufmt::FormatInfo& formatInfo = gpufmt::formatInfo(getLayoutFormat(layout));
+    const gpufmt::FormatInfo& formatInfo = gpufmt::formatInfo(getDecodeFormat(layout));
     const uint32_t channelByteSize = formatInfo.blockByteSize / formatInfo.componentCount;
+
+    Imf::PixelType pixelType = layout.pixelType;
+
+    if(pixelType != Imf::PixelType::UINT)
+    {
+        pixelType = (channelByteSize == 2) ? Imf::PixelType::HALF : Imf::PixelType::FLOAT;
+    }
     int frameBufferCount = 0;
     uint32_t channelOffset = 0u;
 
@@ -326,7 +496,7 @@ int fillFrameBuffer(Imf::FrameBuffer& frameBuffer, glm::ivec2 min, const ExrOpen
         {
             frameBuffer.insert(layout.channels[i].name,
                                Imf::Slice{
-                                   layout.pixelType,                     // type
+                                   pixelType,                            // type
                                    pixelBase + channelOffset,            // base
                                    xStride,                              // xStride
                                    yStride,                              // yStride
@@ -343,6 +513,98 @@ int fillFrameBuffer(Imf::FrameBuffer& frameBuffer, glm::ivec2 min, const ExrOpen
     return frameBufferCount;
 }
 
+// Rows decoded into scratch memory at a time when a region is narrower than the data window. A multiple of the scanline
+// block height of every compression except DWAB.
+constexpr int kRegionBandHeight = 64;
+
+struct RegionTarget
+{
+    const ExrOpenExrImporter::SubViewLayout* layout = nullptr;
+    std::span<std::byte> surface;
+};
+
+std::vector<RegionTarget> collectRegionTargets(ExrOpenExrImporter::Part& part, ITextureAllocator& textureAllocator)
+{
+    std::vector<RegionTarget> targets;
+    targets.reserve(part.totalSubViews);
+
+    for(const ExrOpenExrImporter::View& view : part.views)
+    {
+        for(const ExrOpenExrImporter::SubViewLayout& subViewLayout : view.subViewLayouts)
+        {
+            targets.emplace_back(
+                RegionTarget{&subViewLayout, textureAllocator.accessTextureData(subViewLayout.textureIndex, {})});
+        }
+    }
+
+    return targets;
+}
+
+// OpenEXR always writes whole scanlines, or whole tiles, to a frame buffer. Regions narrower than that, and layouts
+// packed after decoding, are read in bands of bandHeight rows starting at bandOriginY into scratch memory covering
+// columns [bandMinX, bandMaxX], then the region's columns are copied or packed out. readBand(frameBuffer, firstRow,
+// lastRow) reads the band's rows inside the region.
+template<class ReadBand>
+void readRegionInBands(std::span<const RegionTarget> targets, glm::ivec2 regionMin, glm::ivec2 regionMax, int bandMinX,
+                       int bandMaxX, int bandOriginY, int bandHeight, ReadBand&& readBand)
+{
+    const int bandWidth = bandMaxX - bandMinX + 1;
+    const int regionWidth = regionMax.x - regionMin.x + 1;
+
+    std::vector<std::vector<std::byte>> scratchBuffers(targets.size());
+    std::vector<size_t> blockSizes(targets.size());
+
+    for(size_t i = 0; i < targets.size(); ++i)
+    {
+        blockSizes[i] = gpufmt::formatInfo(getDecodeFormat(*targets[i].layout)).blockByteSize;
+        scratchBuffers[i].resize(blockSizes[i] * bandWidth * bandHeight);
+    }
+
+    int bandStartY = bandOriginY + ((regionMin.y - bandOriginY) / bandHeight) * bandHeight;
+
+    for(; bandStartY <= regionMax.y; bandStartY += bandHeight)
+    {
+        const int firstRow = std::max(bandStartY, regionMin.y);
+        const int lastRow = std::min(bandStartY + bandHeight - 1, regionMax.y);
+
+        Imf::FrameBuffer frameBuffer;
+
+        for(size_t i = 0; i < targets.size(); ++i)
+        {
+            fillFrameBuffer(frameBuffer, {bandMinX, bandStartY}, *targets[i].layout,
+                            cputex::Extent{bandWidth, bandHeight, 1}, scratchBuffers[i]);
+        }
+
+        readBand(frameBuffer, firstRow, lastRow);
+
+        for(size_t i = 0; i < targets.size(); ++i)
+        {
+            const gpufmt::Format format = targets[i].layout->format;
+            const size_t blockSize = blockSizes[i];
+            const size_t sourceRowSize = blockSize * regionWidth;
+            const size_t destinationRowSize = gpufmt::formatInfo(format).blockByteSize * regionWidth;
+
+            for(int y = firstRow; y <= lastRow; ++y)
+            {
+                const size_t sourceOffset = (size_t(y - bandStartY) * bandWidth + (regionMin.x - bandMinX)) * blockSize;
+                std::span<const std::byte> source{scratchBuffers[i].data() + sourceOffset, sourceRowSize};
+                std::span<std::byte> destination =
+                    targets[i].surface.subspan(size_t(y - regionMin.y) * destinationRowSize, destinationRowSize);
+
+                if(format == gpufmt::Format::B10G11R11_UFLOAT_PACK32)
+                {
+                    packB10G11R11(castBytes<float>(source), castWritableBytes<uint32_t>(destination));
+                }
+                else if(format == gpufmt::Format::E5B9G9R9_UFLOAT_PACK32)
+                {
+                    packE5B9G9R9(castBytes<float>(source), castWritableBytes<uint32_t>(destination));
+                }
+                else { std::memcpy(destination.data(), source.data(), sourceRowSize); }
+            }
+        }
+    }
+}
+
 void splitChannelName(std::string_view channelName, std::span<const std::string> viewNames, std::string_view& layer,
                       std::string_view& view, std::string_view& channel)
 {
@@ -545,6 +807,23 @@ std::map<std::string, ExrOpenExrImporter::AttributeVariant> parseAttributes(cons
     return attributes;
 }
 
+ExrOpenExrImporter::ExrOpenExrImporter() = default;
+ExrOpenExrImporter::ExrOpenExrImporter(ExrOpenExrImporter&&) = default;
+ExrOpenExrImporter::~ExrOpenExrImporter() = default;
+
+ExrOpenExrImporter& ExrOpenExrImporter::operator=(ExrOpenExrImporter&&) = default;
+
+const std::map<std::string, ExrOpenExrImporter::AttributeVariant>& ExrOpenExrImporter::attributes(size_t partIndex)
+{
+    mPartAttributes.resize(mParts.size());
+
+    std::optional<std::map<std::string, AttributeVariant>>& partAttributes = mPartAttributes.at(partIndex);
+
+    if(!partAttributes) { partAttributes = parseAttributes(mParts[partIndex].header); }
+
+    return *partAttributes;
+}
+
 FileFormat ExrOpenExrImporter::fileFormat() const
 {
     return FileFormat::Exr;
@@ -561,27 +840,148 @@ bool ExrOpenExrImporter::checkSignature(std::istream& stream)
 void ExrOpenExrImporter::load(std::istream& stream, ITextureAllocator& textureAllocator, TextureImportOptions options)
 {
     std::string filePathStr = filePath().string();
-    Imf::StdIStream exrStream{stream, filePathStr.c_str()};
+
+    // read from memory when the import came from a span or the file can be mapped
+    mExrData = mSourceData;
+
+    if(mExrData.empty() && !filePathStr.empty())
+    {
+        mMappedFile = std::make_unique<MemoryMappedFile>();
+
+        if(mMappedFile->open(filePath())) { mExrData = mMappedFile->data(); }
+        else { mMappedFile.reset(); }
+    }
+
+    std::unique_ptr<Imf::IStream> memoryStream;
+    Imf::StdIStream importStream{stream, filePathStr.c_str()};
+
+    if(!mExrData.empty()) { memoryStream = std::make_unique<Imf::MemoryIStream>(mExrData, filePathStr.c_str()); }
+
+    Imf::IStream& exrStream = (memoryStream) ? *memoryStream : static_cast<Imf::IStream&>(importStream);
 
     bool isTiled = Imf::isTiledOpenExrFile(exrStream);
     bool isMultiPart = Imf::isMultiPartOpenExrFile(exrStream);
     bool isDeep = Imf::isDeepOpenExrFile(exrStream);
 
-    if(isMultiPart) { loadMultiPartImage(exrStream, textureAllocator, options); }
+    if(options.thumbnailSize > 0 && loadPreviewImage(exrStream, textureAllocator, options)) {}
+    else if(isMultiPart) { loadMultiPartImage(exrStream, textureAllocator, options); }
     else if(isTiled) { loadTiledImage(exrStream, textureAllocator, options); }
     else if(isDeep) { loadDeepImage(exrStream, textureAllocator, options); }
     else { loadImage(exrStream, textureAllocator, options); }
+
+    // deferred tiles keep reading from the mapping
+    if(!mTiledInputFile)
+    {
+        mMappedFile.reset();
+        mExrData = {};
+    }
+}
+
+std::unique_ptr<Imf::IStream> ExrOpenExrImporter::openExrStream() const
+{
+    std::string filePathStr = filePath().string();
+
+    if(!mExrData.empty()) { return std::make_unique<Imf::MemoryIStream>(mExrData, filePathStr.c_str()); }
+
+    return std::make_unique<Imf::StdIStream>(filePathStr.c_str());
+}
+
+bool ExrOpenExrImporter::loadPreviewImage(Imf::IStream& exrStream, ITextureAllocator& textureAllocator,
+                                          const TextureImportOptions& options)
+{
+    const uint64_t streamPosition = exrStream.tellg();
+    Imf::Header header;
+
+    try
+    {
+        Imf::MultiPartInputFile multiPartInputFile{exrStream, 0};
+        header = multiPartInputFile.header(0);
+    }
+    catch(const std::exception&)
+    {
+        exrStream.clear();
+        exrStream.seekg(streamPosition);
+        return false;
+    }
+
+    exrStream.seekg(streamPosition);
+
+    if(!header.hasPreviewImage()) { return false; }
+
+    const Imf::PreviewImage& previewImage = header.previewImage();
+    const int width = static_cast<int>(previewImage.width());
+    const int height = static_cast<int>(previewImage.height());
+
+    // too small previews are skipped for the full image
+    if(width == 0 || height == 0 || std::max(width, height) < options.thumbnailSize) { return false; }
+
+    // preview pixels are 8 bit and gamma encoded
+    const std::array<FormatLayout, 0> additionalFormatLayouts;
+    const FormatLayout selectedFormatLayout =
+        textureAllocator.selectFormatLayout(FormatLayout::_8_8_8_8, additionalFormatLayouts);
+
+    if(!isValidFormatLayout(FormatLayout::_8_8_8_8, additionalFormatLayouts, selectedFormatLayout))
+    {
+        setTextureAllocatorFormatLayoutError(selectedFormatLayout);
+        return true;
+    }
+
+    const std::array availableFormats = {gpufmt::Format::R8G8B8A8_SRGB};
+    const gpufmt::Format format = textureAllocator.selectFormat(FormatLayout::_8_8_8_8, availableFormats);
+
+    if(!contains(availableFormats, format))
+    {
+        setTextureAllocatorFormatError(format);
+        return true;
+    }
+
+    SubViewLayout layout;
+    layout.channelMask = gpufmt::ChannelMask::Red;
+    layout.channelMask |= gpufmt::ChannelMask::Green;
+    layout.channelMask |= gpufmt::ChannelMask::Blue;
+    layout.channelMask |= gpufmt::ChannelMask::Alpha;
+    layout.pixelType = Imf::PixelType::HALF;
+    layout.format = format;
+    layout.color = true;
+
+    Properties properties;
+    properties.regionMax = {width - 1, height - 1};
+
+    textureAllocator.preAllocation(1);
+
+    if(!createTextureForLayout(textureAllocator, 0, layout, properties)) { return true; }
+
+    textureAllocator.postAllocation();
+
+    Part& part = mParts.emplace_back(Part{header});
+    part.viewNames.emplace_back();
+    part.views.emplace_back().subViewLayouts.emplace_back(layout);
+    part.totalSubViews = 1;
+
+    std::span<std::byte> textureData = textureAllocator.accessTextureData(0, {});
+    const Imf::PreviewRgba* pixels = previewImage.pixels();
+    const size_t pixelCount = static_cast<size_t>(width) * static_cast<size_t>(height);
+
+    for(size_t i = 0; i < pixelCount; ++i)
+    {
+        textureData[i * 4 + 0] = static_cast<std::byte>(pixels[i].r);
+        textureData[i * 4 + 1] = static_cast<std::byte>(pixels[i].g);
+        textureData[i * 4 + 2] = static_cast<std::byte>(pixels[i].b);
+        textureData[i * 4 + 3] = static_cast<std::byte>(pixels[i].a);
+    }
+
+    return true;
 }
 
-void ExrOpenExrImporter::loadDeepImage(Imf::StdIStream&, ITextureAllocator&, TextureImportOptions)
+void ExrOpenExrImporter::loadDeepImage(Imf::IStream&, ITextureAllocator&, TextureImportOptions)
 {
     setError(TextureImportError::UnsupportedFeature, "EXR deep images are not currently supported");
 }
 
-void ExrOpenExrImporter::loadImage(Imf::StdIStream& exrStream, ITextureAllocator& textureAllocator,
-                                   TextureImportOptions /*options*/)
+void ExrOpenExrImporter::loadImage(Imf::IStream& exrStream, ITextureAllocator& textureAllocator,
+                                   TextureImportOptions options)
 {
-    Imf::InputFile inputFile{exrStream};
+    Imf::InputFile inputFile{exrStream, prepareExrThreadCount(options.threadCount)};
 
     mParts.reserve(1);
     Part& part = mParts.emplace_back(Part{inputFile.header()});
@@ -614,16 +1014,11 @@ void ExrOpenExrImporter::loadImage(Imf::StdIStream& exrStream, ITextureAllocator
         else { part.viewNames.emplace_back(); }
     }
 
-    Properties properties;
-    const Imath::Box2i& dataWindow = inputFile.header().dataWindow();
-    properties.dataWindowMin = {dataWindow.min.x, dataWindow.min.y};
-    properties.dataWindowMax = {dataWindow.max.x, dataWindow.max.y};
+    Properties properties = readProperties(inputFile.header());
 
-    const Imath::Box2i& displayWindow = inputFile.header().displayWindow();
-    properties.displayWindowMin = {displayWindow.min.x, displayWindow.min.y};
-    properties.displayWindowMax = {displayWindow.max.x, displayWindow.max.y};
+    if(!applyRegion(properties, options.region)) { return; }
 
-    extractAllLayouts(properties, part, textureAllocator);
+    extractAllLayouts(properties, part, options.channelFilter, textureAllocator);
 
     for(const View& view : part.views)
     {
@@ -636,6 +1031,8 @@ void ExrOpenExrImporter::loadImage(Imf::StdIStream& exrStream, ITextureAllocator
         return;
     }
 
+    if(!selectLayoutFormats(part, true, textureAllocator)) { return; }
+
     textureAllocator.preAllocation(part.totalSubViews);
     
     if(allocateTextures(properties, part, 0, textureAllocator) == 0)
@@ -645,34 +1042,50 @@ void ExrOpenExrImporter::loadImage(Imf::StdIStream& exrStream, ITextureAllocator
 
     textureAllocator.postAllocation();
 
-    Imf::FrameBuffer frameBuffer;
-    fillFrameBuffers(properties, part, std::span(&frameBuffer, 1), textureAllocator);
-
-    inputFile.setFrameBuffer(frameBuffer);
-    inputFile.readPixels(dataWindow.min.y, dataWindow.max.y);
+    if(properties.regionSpansDataWindowWidth() && !hasPackedLayout(part))
+    {
+        Imf::FrameBuffer frameBuffer;
+        fillFrameBuffers(properties, part, std::span(&frameBuffer, 1), textureAllocator);
 
-    part.attributes = parseAttributes(inputFile.header());
+        inputFile.setFrameBuffer(frameBuffer);
+        inputFile.readPixels(properties.regionMin.y, properties.regionMax.y);
+    }
+    else
+    {
+        std::vector<RegionTarget> targets = collectRegionTargets(part, textureAllocator);
+
+        readRegionInBands(targets, properties.regionMin, properties.regionMax, properties.dataWindowMin.x,
+                          properties.dataWindowMax.x, properties.dataWindowMin.y, kRegionBandHeight,
+                          [&inputFile](Imf::FrameBuffer& frameBuffer, int firstRow, int lastRow)
+                          {
+                              inputFile.setFrameBuffer(frameBuffer);
+                              inputFile.readPixels(firstRow, lastRow);
+                          });
+    }
 }
 
-void ExrOpenExrImporter::loadMultiPartImage(Imf::StdIStream& exrStream, ITextureAllocator& textureAllocator,
-                                            TextureImportOptions /*options*/)
+void ExrOpenExrImporter::loadMultiPartImage(Imf::IStream& exrStream, ITextureAllocator& textureAllocator,
+                                            TextureImportOptions options)
 {
-    Imf::MultiPartInputFile multiPartInputFile{exrStream};
+    Imf::MultiPartInputFile multiPartInputFile{exrStream, prepareExrThreadCount(options.threadCount)};
     int partsCount = multiPartInputFile.parts();
     mParts.reserve(partsCount);
 
+    std::vector<Properties> partProperties;
+    partProperties.reserve(partsCount);
+
     int textureCount = 0;
 
     for(int i = 0; i < partsCount; ++i)
     {
-        Imf::InputPart inputFilePart{multiPartInputFile, i};
+        const Imf::Header& header = multiPartInputFile.header(i);
 
-        Part& part = mParts.emplace_back(Part{inputFilePart.header()});
+        Part& part = mParts.emplace_back(Part{header});
         part.header.channels().layers(part.layerNames);
 
-        if(Imf::hasMultiView(inputFilePart.header()))
+        if(Imf::hasMultiView(header))
         {
-            part.viewNames = Imf::multiView(inputFilePart.header());
+            part.viewNames = Imf::multiView(header);
 
             part.views.reserve(part.viewNames.size());
 
@@ -696,31 +1109,29 @@ void ExrOpenExrImporter::loadMultiPartImage(Imf::StdIStream& exrStream, ITexture
             else { part.viewNames.emplace_back(); }
         }
 
-        Properties properties;
-        const Imath::Box2i& dataWindow = inputFilePart.header().dataWindow();
-        properties.dataWindowMin = {dataWindow.min.x, dataWindow.min.y};
-        properties.dataWindowMax = {dataWindow.max.x, dataWindow.max.y};
+        Properties& properties = partProperties.emplace_back(readProperties(header));
 
-        const Imath::Box2i& displayWindow = inputFilePart.header().displayWindow();
-        properties.displayWindowMin = {displayWindow.min.x, displayWindow.min.y};
-        properties.displayWindowMax = {displayWindow.max.x, displayWindow.max.y};
+        if(!applyRegion(properties, options.region)) { return; }
 
-        extractAllLayouts(properties, part, textureAllocator);
+        extractAllLayouts(properties, part, options.channelFilter, textureAllocator);
 
         for(const View& view : part.views)
         {
             part.totalSubViews += static_cast<int>(view.subViewLayouts.size());
         }
 
-        if(part.totalSubViews == 0)
-        {
-            setError(TextureImportError::UnsupportedFeature, "No valid layers or channels.");
-            return;
-        }
+        // parts without selected channels are skipped, the channel filter can pick a few layers out of many parts
+        if(part.totalSubViews == 0) { continue; }
+
+        if(!selectLayoutFormats(part, true, textureAllocator)) { return; }
 
         textureCount += part.totalSubViews;
+    }
 
-        part.attributes = parseAttributes(inputFilePart.header());
+    if(textureCount == 0)
+    {
+        setError(TextureImportError::UnsupportedFeature, "No valid layers or channels.");
+        return;
     }
 
     textureAllocator.preAllocation(textureCount);
@@ -729,20 +1140,9 @@ void ExrOpenExrImporter::loadMultiPartImage(Imf::StdIStream& exrStream, ITexture
 
     for(int i = 0; i < partsCount; ++i)
     {
-        Imf::InputPart inputFilePart{multiPartInputFile, i};
-
-        Properties properties;
-        const Imath::Box2i& dataWindow = inputFilePart.header().dataWindow();
-        properties.dataWindowMin = {dataWindow.min.x, dataWindow.min.y};
-        properties.dataWindowMax = {dataWindow.max.x, dataWindow.max.y};
+        if(mParts[i].totalSubViews == 0) { continue; }
 
-        const Imath::Box2i& displayWindow = inputFilePart.header().displayWindow();
-        properties.displayWindowMin = {displayWindow.min.x, displayWindow.min.y};
-        properties.displayWindowMax = {displayWindow.max.x, displayWindow.max.y};
-
-        Imf::FrameBuffer frameBuffer;
-
-        int allocationCount = allocateTextures(properties, mParts[i], textureIndex, textureAllocator);
+        int allocationCount = allocateTextures(partProperties[i], mParts[i], textureIndex, textureAllocator);
 
         if(allocationCount == 0)
         {
@@ -754,39 +1154,81 @@ void ExrOpenExrImporter::loadMultiPartImage(Imf::StdIStream& exrStream, ITexture
 
     textureAllocator.postAllocation();
 
+    std::vector<Imf::FrameBuffer> frameBuffers(partsCount);
+    std::vector<std::vector<RegionTarget>> regionTargets(partsCount);
+    std::vector<std::unique_ptr<Imf::InputPart>> inputParts;
+    inputParts.reserve(partsCount);
+
     for(int i = 0; i < partsCount; ++i)
     {
-        Imf::InputPart inputFilePart{multiPartInputFile, i};
-
-        Properties properties;
-        const Imath::Box2i& dataWindow = inputFilePart.header().dataWindow();
-        properties.dataWindowMin = {dataWindow.min.x, dataWindow.min.y};
-        properties.dataWindowMax = {dataWindow.max.x, dataWindow.max.y};
+        if(mParts[i].totalSubViews == 0)
+        {
+            inputParts.emplace_back();
+            continue;
+        }
 
-        const Imath::Box2i& displayWindow = inputFilePart.header().displayWindow();
-        properties.displayWindowMin = {displayWindow.min.x, displayWindow.min.y};
-        properties.displayWindowMax = {displayWindow.max.x, displayWindow.max.y};
+        auto& inputPart = inputParts.emplace_back(std::make_unique<Imf::InputPart>(multiPartInputFile, i));
 
-        Imf::FrameBuffer frameBuffer;
-        fillFrameBuffers(properties, mParts[i], std::span(&frameBuffer, 1), textureAllocator);
+        if(partProperties[i].regionSpansDataWindowWidth() && !hasPackedLayout(mParts[i]))
+        {
+            fillFrameBuffers(partProperties[i], mParts[i], std::span(&frameBuffers[i], 1), textureAllocator);
+            inputPart->setFrameBuffer(frameBuffers[i]);
+        }
+        else { regionTargets[i] = collectRegionTargets(mParts[i], textureAllocator); }
+    }
 
-        inputFilePart.setFrameBuffer(frameBuffer);
-        inputFilePart.readPixels(dataWindow.min.y, dataWindow.max.y);
+    // parts share the file's stream behind OpenEXR's stream mutex, so only the chunk reads are serialized and the parts
+    // decompress concurrently
+    std::vector<std::string> partErrors(partsCount);
+
+    parallelFor(partsCount, resolveThreadCount(options.threadCount),
+                [&](int i)
+                {
+                    if(!inputParts[i]) { return; }
+
+                    const Properties& properties = partProperties[i];
+                    Imf::InputPart& inputPart = *inputParts[i];
+
+                    try
+                    {
+                        if(regionTargets[i].empty())
+                        {
+                            inputPart.readPixels(properties.regionMin.y, properties.regionMax.y);
+                            return;
+                        }
+
+                        readRegionInBands(regionTargets[i], properties.regionMin, properties.regionMax,
+                                          properties.dataWindowMin.x, properties.dataWindowMax.x,
+                                          properties.dataWindowMin.y, kRegionBandHeight,
+                                          [&inputPart](Imf::FrameBuffer& frameBuffer, int firstRow, int lastRow)
+                                          {
+                                              inputPart.setFrameBuffer(frameBuffer);
+                                              inputPart.readPixels(firstRow, lastRow);
+                                          });
+                    }
+                    catch(const std::exception& exception)
+                    {
+                        partErrors[i] = exception.what();
+                    }
+                });
+
+    for(std::string& partError : partErrors)
+    {
+        if(!partError.empty())
+        {
+            setError(TextureImportError::InvalidDataInImage, std::move(partError));
+            return;
+        }
     }
 }
 
-void ExrOpenExrImporter::loadTiledImage(Imf::StdIStream& exrStream, ITextureAllocator& textureAllocator,
-                                        TextureImportOptions /*options*/)
+void ExrOpenExrImporter::loadTiledImage(Imf::IStream& exrStream, ITextureAllocator& textureAllocator,
+                                        TextureImportOptions options)
 {
-    Imf::TiledInputFile inputFile{exrStream};
+    Imf::TiledInputFile inputFile{exrStream, prepareExrThreadCount(options.threadCount)};
 
-    if(inputFile.levelMode() == Imf::LevelMode::RIPMAP_LEVELS)
-    {
-        setError(TextureImportError::UnsupportedFeature, "EXR tiled images with ripmaps are not currently supported");
-        return;
-    }
-
-    if(inputFile.levelRoundingMode() == Imf::LevelRoundingMode::ROUND_UP)
+    // deferred tiles report their level extents through tileLevels() so they don't need to match cputex's mip extents
+    if(!options.deferTileLoading && inputFile.levelRoundingMode() == Imf::LevelRoundingMode::ROUND_UP)
     {
         setError(TextureImportError::UnsupportedFeature,
                  "EXR tiled images with level rounding mode 'round up' are not currently supported");
@@ -818,18 +1260,18 @@ void ExrOpenExrImporter::loadTiledImage(Imf::StdIStream& exrStream, ITextureAllo
         part.viewNames.emplace_back();
     }
 
-    Properties properties;
-    const Imath::Box2i& dataWindow = inputFile.header().dataWindow();
-    properties.dataWindowMin = {dataWindow.min.x, dataWindow.min.y};
-    properties.dataWindowMax = {dataWindow.max.x, dataWindow.max.y};
+    Properties properties = readProperties(inputFile.header());
 
-    const Imath::Box2i& displayWindow = inputFile.header().displayWindow();
-    properties.displayWindowMin = {displayWindow.min.x, displayWindow.min.y};
-    properties.displayWindowMax = {displayWindow.max.x, displayWindow.max.y};
+    // ripmaps are imported as a mip chain made of their levels with matching x and y reductions
+    if(inputFile.levelMode() == Imf::LevelMode::RIPMAP_LEVELS)
+    {
+        properties.mips = std::min(inputFile.numXLevels(), inputFile.numYLevels());
+    }
+    else { properties.mips = inputFile.numLevels(); }
 
-    properties.mips = inputFile.numLevels();
+    if(!applyRegion(properties, options.region)) { return; }
 
-    extractAllLayouts(properties, part, textureAllocator);
+    extractAllLayouts(properties, part, options.channelFilter, textureAllocator);
 
     for(const View& view : part.views)
     {
@@ -842,6 +1284,15 @@ void ExrOpenExrImporter::loadTiledImage(Imf::StdIStream& exrStream, ITextureAllo
         return;
     }
 
+    // packing happens after decoding, which the mip and deferred tile reads don't do
+    if(!selectLayoutFormats(part, properties.mips == 1 && !options.deferTileLoading, textureAllocator)) { return; }
+
+    if(options.deferTileLoading)
+    {
+        openDeferredTiles(options);
+        return;
+    }
+
     textureAllocator.preAllocation(1);
     if(allocateTextures(properties, part, 0, textureAllocator) == 0)
     {
@@ -849,19 +1300,313 @@ void ExrOpenExrImporter::loadTiledImage(Imf::StdIStream& exrStream, ITextureAllo
     }
     textureAllocator.postAllocation();
 
-    std::vector<Imf::FrameBuffer> frameBuffers(properties.mips);
-    fillFrameBuffers(properties, part, frameBuffers, textureAllocator);
+    if(properties.regionMin == properties.dataWindowMin && properties.regionMax == properties.dataWindowMax &&
+       !hasPackedLayout(part))
+    {
+        std::vector<Imf::FrameBuffer> frameBuffers(properties.mips);
+        fillFrameBuffers(properties, part, frameBuffers, textureAllocator);
+
+        struct TileRow
+        {
+            int mip = 0;
+            int tileY = 0;
+        };
+
+        std::vector<TileRow> tileRows;
+
+        for(int mip = 0; mip < properties.mips; ++mip)
+        {
+            for(int tileY = 0; tileY < inputFile.numYTiles(mip); ++tileY)
+            {
+                tileRows.emplace_back(TileRow{mip, tileY});
+            }
+        }
+
+        // every level has its own frame buffer, so the rows of tiles of all levels are spread over workers that each
+        // read through their own TiledInputFile. the extra handles open their own stream over the mapped data or the
+        // file, the import stream can't be shared.
+        int workerCount = 1;
+
+        if(properties.mips > 1 && (!mExrData.empty() || !filePath().empty()))
+        {
+            workerCount = std::min(resolveThreadCount(options.threadCount), static_cast<int>(tileRows.size()));
+        }
+
+        std::atomic<int> nextTileRow{0};
+        std::vector<std::string> workerErrors(workerCount);
+
+        parallelFor(workerCount, workerCount,
+                    [&](int worker)
+                    {
+                        try
+                        {
+                            std::unique_ptr<Imf::IStream> workerStream;
+                            std::unique_ptr<Imf::TiledInputFile> workerInputFile;
+                            Imf::TiledInputFile* tiledInputFile = &inputFile;
+
+                            if(worker > 0)
+                            {
+                                workerStream = openExrStream();
+                                workerInputFile = std::make_unique<Imf::TiledInputFile>(*workerStream, 0);
+                                tiledInputFile = workerInputFile.get();
+                            }
+
+                            int frameBufferMip = -1;
+
+                            for(int i = nextTileRow++; i < static_cast<int>(tileRows.size()); i = nextTileRow++)
+                            {
+                                const TileRow& tileRow = tileRows[i];
+
+                                if(tileRow.mip != frameBufferMip)
+                                {
+                                    tiledInputFile->setFrameBuffer(frameBuffers[tileRow.mip]);
+                                    frameBufferMip = tileRow.mip;
+                                }
+
+                                tiledInputFile->readTiles(0, tiledInputFile->numXTiles(tileRow.mip) - 1, tileRow.tileY,
+                                                          tileRow.tileY, tileRow.mip, tileRow.mip);
+                            }
+                        }
+                        catch(const std::exception& exception)
+                        {
+                            workerErrors[worker] = exception.what();
+                        }
+                    });
+
+        for(std::string& workerError : workerErrors)
+        {
+            if(!workerError.empty())
+            {
+                setError(TextureImportError::InvalidDataInImage, std::move(workerError));
+                return;
+            }
+        }
+    }
+    else
+    {
+        // only the tiles overlapping the region are decoded, one row of tiles at a time
+        const int tileWidth = static_cast<int>(inputFile.tileXSize());
+        const int tileHeight = static_cast<int>(inputFile.tileYSize());
+
+        const int firstTileX = (properties.regionMin.x - properties.dataWindowMin.x) / tileWidth;
+        const int lastTileX = (properties.regionMax.x - properties.dataWindowMin.x) / tileWidth;
+        const int bandMinX = properties.dataWindowMin.x + firstTileX * tileWidth;
+        const int bandMaxX =
+            std::min(properties.dataWindowMax.x, properties.dataWindowMin.x + (lastTileX + 1) * tileWidth - 1);
+
+        std::vector<RegionTarget> targets = collectRegionTargets(part, textureAllocator);
+
+        readRegionInBands(targets, properties.regionMin, properties.regionMax, bandMinX, bandMaxX,
+                          properties.dataWindowMin.y, tileHeight,
+                          [&](Imf::FrameBuffer& frameBuffer, int firstRow, int /*lastRow*/)
+                          {
+                              const int tileY = (firstRow - properties.dataWindowMin.y) / tileHeight;
+
+                              inputFile.setFrameBuffer(frameBuffer);
+                              inputFile.readTiles(firstTileX, lastTileX, tileY, tileY, 0);
+                          });
+    }
+}
+
+void ExrOpenExrImporter::openDeferredTiles(const TextureImportOptions& options)
+{
+    // the import stream is closed once the import returns, tiles are read through a stream of our own
+    mTileStream = openExrStream();
+    mTiledInputFile = std::make_unique<Imf::TiledInputFile>(*mTileStream, prepareExrThreadCount(options.threadCount));
+
+    mTileSize = {static_cast<int>(mTiledInputFile->tileXSize()), static_cast<int>(mTiledInputFile->tileYSize())};
 
-    for(int mip = 0; mip < properties.mips; ++mip)
+    auto addTileLevel = [this](int levelX, int levelY)
     {
-        int xTiles = inputFile.numXTiles(mip);
-        int yTiles = inputFile.numYTiles(mip);
+        mTileLevels.emplace_back(TileLevel{
+            .levelX = levelX,
+            .levelY = levelY,
+            .extent = {mTiledInputFile->levelWidth(levelX), mTiledInputFile->levelHeight(levelY)},
+            .tileCount = {mTiledInputFile->numXTiles(levelX), mTiledInputFile->numYTiles(levelY)}
+        });
+    };
 
-        inputFile.setFrameBuffer(frameBuffers[mip]);
-        inputFile.readTiles(0, xTiles - 1, 0, yTiles - 1, mip);
+    if(mTiledInputFile->levelMode() == Imf::LevelMode::RIPMAP_LEVELS)
+    {
+        for(int levelY = 0; levelY < mTiledInputFile->numYLevels(); ++levelY)
+        {
+            for(int levelX = 0; levelX < mTiledInputFile->numXLevels(); ++levelX)
+            {
+                addTileLevel(levelX, levelY);
+            }
+        }
     }
+    else
+    {
+        for(int level = 0; level < mTiledInputFile->numLevels(); ++level)
+        {
+            addTileLevel(level, level);
+        }
+    }
+}
+
+bool ExrOpenExrImporter::readTile(const TileKey& key, ITextureAllocator& tileAllocator)
+{
+    if(!mTiledInputFile)
+    {
+        setError(TextureImportError::Unknown, "Tiles can only be read from tiled images imported with deferred tiles.");
+        return false;
+    }
+
+    if(!mTiledInputFile->isValidTile(key.tileX, key.tileY, key.levelX, key.levelY))
+    {
+        setError(TextureImportError::InvalidDataInImage, "The tile is outside of the image's levels.");
+        return false;
+    }
+
+    const Imath::Box2i tileBox = mTiledInputFile->dataWindowForTile(key.tileX, key.tileY, key.levelX, key.levelY);
+
+    Properties tileProperties;
+    tileProperties.regionMin = {tileBox.min.x, tileBox.min.y};
+    tileProperties.regionMax = {tileBox.max.x, tileBox.max.y};
+
+    Part& part = mParts.front();
+
+    tileAllocator.preAllocation(part.totalSubViews);
+
+    if(allocateTextures(tileProperties, part, 0, tileAllocator) == 0) { return false; }
+
+    tileAllocator.postAllocation();
+
+    Imf::FrameBuffer frameBuffer;
+    fillFrameBuffers(tileProperties, part, std::span(&frameBuffer, 1), tileAllocator);
+
+    try
+    {
+        mTiledInputFile->setFrameBuffer(frameBuffer);
+        mTiledInputFile->readTile(key.tileX, key.tileY, key.levelX, key.levelY);
+    }
+    catch(const std::exception& exception)
+    {
+        setError(TextureImportError::InvalidDataInImage, exception.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool ExrOpenExrImporter::selectLayoutFormats(Part& part, bool allowPackedLayouts, ITextureAllocator& textureAllocator)
+{
+    constexpr std::array halfFormatLayouts = {FormatLayout::_16, FormatLayout::_16_16, FormatLayout::_16_16_16,
+                                              FormatLayout::_16_16_16_16};
+    constexpr std::array halfFormats = {gpufmt::Format::R16_SFLOAT, gpufmt::Format::R16G16_SFLOAT,
+                                        gpufmt::Format::R16G16B16_SFLOAT, gpufmt::Format::R16G16B16A16_SFLOAT};
+    constexpr std::array fullFormatLayouts = {FormatLayout::_32, FormatLayout::_32_32, FormatLayout::_32_32_32,
+                                              FormatLayout::_32_32_32_32};
+
+    for(View& view : part.views)
+    {
+        for(SubViewLayout& subViewLayout : view.subViewLayouts)
+        {
+            const gpufmt::Format nativeFormat = getLayoutFormat(subViewLayout);
+            const size_t componentIndex = gpufmt::formatInfo(nativeFormat).componentCount - 1;
+
+            const FormatLayout nativeFormatLayout = (subViewLayout.pixelType == Imf::PixelType::HALF)
+                                                        ? halfFormatLayouts[componentIndex]
+                                                        : fullFormatLayouts[componentIndex];
+
+            std::array<FormatLayout, 3> additionalLayouts;
+            size_t additionalLayoutCount = 0;
+
+            if(subViewLayout.pixelType == Imf::PixelType::FLOAT)
+            {
+                additionalLayouts[additionalLayoutCount++] = halfFormatLayouts[componentIndex];
+            }
+
+            const bool isRgb = enumMaskTest(subViewLayout.channelMask, gpufmt::ChannelMask::Red) &&
+                               enumMaskTest(subViewLayout.channelMask, gpufmt::ChannelMask::Green) &&
+                               enumMaskTest(subViewLayout.channelMask, gpufmt::ChannelMask::Blue) &&
+                               !enumMaskTest(subViewLayout.channelMask, gpufmt::ChannelMask::Alpha);
 
-    part.attributes = parseAttributes(inputFile.header());
+            if(allowPackedLayouts && subViewLayout.color && isRgb && subViewLayout.pixelType != Imf::PixelType::UINT)
+            {
+                additionalLayouts[additionalLayoutCount++] = FormatLayout::_11_11_10;
+                additionalLayouts[additionalLayoutCount++] = FormatLayout::_9_9_9_5;
+            }
+
+            const std::span<const FormatLayout> additionalFormatLayouts{additionalLayouts.data(),
+                                                                        additionalLayoutCount};
+
+            const FormatLayout selectedFormatLayout =
+                textureAllocator.selectFormatLayout(nativeFormatLayout, additionalFormatLayouts);
+
+            if(!isValidFormatLayout(nativeFormatLayout, additionalFormatLayouts, selectedFormatLayout))
+            {
+                setTextureAllocatorFormatLayoutError(selectedFormatLayout);
+                return false;
+            }
+
+            gpufmt::Format layoutFormat = nativeFormat;
+
+            if(selectedFormatLayout == FormatLayout::_11_11_10)
+            {
+                layoutFormat = gpufmt::Format::B10G11R11_UFLOAT_PACK32;
+            }
+            else if(selectedFormatLayout == FormatLayout::_9_9_9_5)
+            {
+                layoutFormat = gpufmt::Format::E5B9G9R9_UFLOAT_PACK32;
+            }
+            else if(selectedFormatLayout != nativeFormatLayout) { layoutFormat = halfFormats[componentIndex]; }
+
+            const std::array availableFormats = {layoutFormat};
+            const gpufmt::Format format = textureAllocator.selectFormat(selectedFormatLayout, availableFormats);
+
+            if(!contains(availableFormats, format))
+            {
+                setTextureAllocatorFormatError(format);
+                return false;
+            }
+
+            subViewLayout.format = format;
+        }
+    }
+
+    return true;
+}
+
+ExrOpenExrImporter::Properties ExrOpenExrImporter::readProperties(const Imf::Header& header)
+{
+    Properties properties;
+    const Imath::Box2i& dataWindow = header.dataWindow();
+    properties.dataWindowMin = {dataWindow.min.x, dataWindow.min.y};
+    properties.dataWindowMax = {dataWindow.max.x, dataWindow.max.y};
+
+    const Imath::Box2i& displayWindow = header.displayWindow();
+    properties.displayWindowMin = {displayWindow.min.x, displayWindow.min.y};
+    properties.displayWindowMax = {displayWindow.max.x, displayWindow.max.y};
+
+    properties.regionMin = properties.dataWindowMin;
+    properties.regionMax = properties.dataWindowMax;
+
+    return properties;
+}
+
+bool ExrOpenExrImporter::applyRegion(Properties& properties, const std::optional<ImportRegion>& region)
+{
+    if(!region) { return true; }
+
+    const glm::ivec2 regionMin{properties.dataWindowMin.x + region->x, properties.dataWindowMin.y + region->y};
+    const glm::ivec2 regionMax{regionMin.x + region->width - 1, regionMin.y + region->height - 1};
+
+    properties.regionMin = {std::max(properties.regionMin.x, regionMin.x),
+                            std::max(properties.regionMin.y, regionMin.y)};
+    properties.regionMax = {std::min(properties.regionMax.x, regionMax.x),
+                            std::min(properties.regionMax.y, regionMax.y)};
+
+    if(properties.regionMin.x > properties.regionMax.x || properties.regionMin.y > properties.regionMax.y)
+    {
+        setError(TextureImportError::InvalidDataInImage, "The import region doesn't overlap the data window.");
+        return false;
+    }
+
+    // the mips of a partial image don't line up with the file's levels, only the base level is imported
+    properties.mips = 1;
+    return true;
 }
 
 bool ExrOpenExrImporter::createTextureForLayout(ITextureAllocator& textureAllocator, int textureIndex,
@@ -870,12 +1615,12 @@ bool ExrOpenExrImporter::createTextureForLayout(ITextureAllocator& textureAlloca
     cputex::TextureParams params;
     params.arraySize = 1;
     params.dimension = cputex::TextureDimension::Texture2D;
-    params.extent = cputex::Extent{properties.dataWindowMax.x - properties.dataWindowMin.x + 1,
-                                   properties.dataWindowMax.y - properties.dataWindowMin.y + 1, 1};
+    params.extent = cputex::Extent{properties.regionMax.x - properties.regionMin.x + 1,
+                                   properties.regionMax.y - properties.regionMin.y + 1, 1};
     params.faces = 1;
     params.mips = properties.mips;
     params.surfaceByteAlignment = 4;
-    params.format = getLayoutFormat(layout);
+    params.format = layout.format;
 
     if(!textureAllocator.allocateTexture(params, textureIndex))
     {
@@ -888,10 +1633,11 @@ bool ExrOpenExrImporter::createTextureForLayout(ITextureAllocator& textureAlloca
 }
 
 void ExrOpenExrImporter::extractAllLayouts(const Properties& properties, Part& part,
+                                           const std::function<bool(std::string_view)>& channelFilter,
                                            ITextureAllocator& textureAllocator)
 {
     static const std::string emptyString;
-    assignChannelsToLayouts(part.header.channels(), emptyString, part.views.front().subViewLayouts);
+    assignChannelsToLayouts(part.header.channels(), emptyString, channelFilter, part.views.front().subViewLayouts);
 
     for(const std::string& layerName : part.layerNames)
     {
@@ -922,9 +1668,10 @@ void ExrOpenExrImporter::extractAllLayouts(const Properties& properties, Part& p
 
         if(findItr == part.views.end())
         {
-            assignChannelsToLayouts(part.header.channels(), layerName, part.views.front().subViewLayouts);
+            assignChannelsToLayouts(part.header.channels(), layerName, channelFilter,
+                                    part.views.front().subViewLayouts);
         }
-        else { assignChannelsToLayouts(part.header.channels(), layerName, findItr->subViewLayouts); }
+        else { assignChannelsToLayouts(part.header.channels(), layerName, channelFilter, findItr->subViewLayouts); }
     }
 
     // remove all empty views
@@ -967,8 +1714,8 @@ int ExrOpenExrImporter::allocateTextures(const Properties& properties, Part& par
 void ExrOpenExrImporter::fillFrameBuffers(const Properties& properties, Part& part,
                                           std::span<Imf::FrameBuffer> frameBuffers, ITextureAllocator& textureAllocator)
 {
-    const cputex::Extent textureExtent{properties.dataWindowMax.x - properties.dataWindowMin.x + 1,
-                                       properties.dataWindowMax.y - properties.dataWindowMin.y + 1, 1};
+    const cputex::Extent textureExtent{properties.regionMax.x - properties.regionMin.x + 1,
+                                       properties.regionMax.y - properties.regionMin.y + 1, 1};
 
     for(View& view : part.views)
     {
@@ -979,7 +1726,7 @@ void ExrOpenExrImporter::fillFrameBuffers(const Properties& properties, Part& pa
                 std::span<std::byte> mipData = textureAllocator.accessTextureData(
                     subViewLayout.textureIndex, MipSurfaceKey{.arraySlice = 0, .face = 0, .mip = (int8_t)mip});
 
-                fillFrameBuffer(frameBuffers[mip], properties.dataWindowMin, subViewLayout,
+                fillFrameBuffer(frameBuffers[mip], properties.regionMin, subViewLayout,
                                 cputex::calculateMipExtent(textureExtent, mip), mipData);
             }
         }
@@ -0,0 +1,634 @@
+#include <teximp/exr/exr_importer.openexr_core.h>
+
+#ifdef TEXIMP_ENABLE_EXR_BACKEND_OPENEXR_CORE
+
+#include "memory_mapped_file.h"
+#include "utilities.h"
+
+#include <cputex/utility.h>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include <gsl/gsl-lite.hpp>
+
+namespace teximp::exr
+{
+// Everything Core reads goes through here. Chunks are read concurrently by the decode workers, memory is read without
+// locking and the import stream is shared behind a mutex.
+struct ExrSource
+{
+    std::span<const std::byte> data;
+    std::istream* stream = nullptr;
+    int64_t streamSize = 0;
+    std::mutex streamMutex;
+};
+
+int64_t readExrSource(exr_const_context_t /*context*/, void* userData, void* buffer, uint64_t size, uint64_t offset,
+                      exr_stream_error_func_ptr_t /*errorCallback*/)
+{
+    ExrSource& source = *static_cast<ExrSource*>(userData);
+
+    if(source.stream == nullptr)
+    {
+        if(offset >= source.data.size()) { return -1; }
+
+        const uint64_t readSize = std::min<uint64_t>(size, source.data.size() - offset);
+        std::memcpy(buffer, source.data.data() + offset, readSize);
+        return static_cast<int64_t>(readSize);
+    }
+
+    std::scoped_lock lock{source.streamMutex};
+
+    source.stream->clear();
+    source.stream->seekg(static_cast<std::streamoff>(offset));
+    source.stream->read(static_cast<char*>(buffer), static_cast<std::streamsize>(size));
+
+    return static_cast<int64_t>(source.stream->gcount());
+}
+
+int64_t queryExrSourceSize(exr_const_context_t /*context*/, void* userData)
+{
+    const ExrSource& source = *static_cast<const ExrSource*>(userData);
+
+    return (source.stream == nullptr) ? static_cast<int64_t>(source.data.size()) : source.streamSize;
+}
+
+// errors are reported through the returned result codes instead of Core's default stderr handler
+void ignoreExrError(exr_const_context_t /*context*/, exr_result_t /*result*/, const char* /*message*/) {}
+
+[[nodiscard]] int layoutComponentCount(gpufmt::ChannelMask channelMask)
+{
+    if(enumMaskTest(channelMask, gpufmt::ChannelMask::Alpha)) { return 4; }
+    else if(enumMaskTest(channelMask, gpufmt::ChannelMask::Blue)) { return 3; }
+    else if(enumMaskTest(channelMask, gpufmt::ChannelMask::Green)) { return 2; }
+    else { return 1; }
+}
+
+gpufmt::Format getLayoutFormat(const ExrOpenExrCoreImporter::TextureLayout& layout)
+{
+    constexpr std::array halfFormats = {gpufmt::Format::R16_SFLOAT, gpufmt::Format::R16G16_SFLOAT,
+                                        gpufmt::Format::R16G16B16_SFLOAT, gpufmt::Format::R16G16B16A16_SFLOAT};
+    constexpr std::array floatFormats = {gpufmt::Format::R32_SFLOAT, gpufmt::Format::R32G32_SFLOAT,
+                                         gpufmt::Format::R32G32B32_SFLOAT, gpufmt::Format::R32G32B32A32_SFLOAT};
+    constexpr std::array uintFormats = {gpufmt::Format::R32_UINT, gpufmt::Format::R32G32_UINT,
+                                        gpufmt::Format::R32G32B32_UINT, gpufmt::Format::R32G32B32A32_UINT};
+
+    const int componentIndex = layoutComponentCount(layout.channelMask) - 1;
+
+    switch(layout.pixelType)
+    {
+    case EXR_PIXEL_HALF: return halfFormats[componentIndex];
+    case EXR_PIXEL_FLOAT: return floatFormats[componentIndex];
+    case EXR_PIXEL_UINT: return uintFormats[componentIndex];
+    default: return gpufmt::Format::UNDEFINED;
+    }
+}
+
+FileFormat ExrOpenExrCoreImporter::fileFormat() const
+{
+    return FileFormat::Exr;
+}
+
+bool ExrOpenExrCoreImporter::checkSignature(std::istream& stream)
+{
+    constexpr std::array<uint8_t, 4> exrSignature = {0x76, 0x2F, 0x31, 0x01};
+    std::array<uint8_t, 4> fileSignature;
+
+    stream.read(reinterpret_cast<char*>(fileSignature.data()), fileSignature.size());
+
+    return !stream.fail() && fileSignature == exrSignature;
+}
+
+void ExrOpenExrCoreImporter::setErrorFromExr(exr_result_t result, TextureImportError error)
+{
+    if(result == EXR_ERR_READ_IO) { error = TextureImportError::FailedToReadFile; }
+    else if(result == EXR_ERR_FILE_BAD_HEADER) { error = TextureImportError::CouldNotReadHeader; }
+
+    setError(error, exr_get_default_error_message(result));
+}
+
+void ExrOpenExrCoreImporter::load(std::istream& stream, ITextureAllocator& textureAllocator,
+                                  TextureImportOptions options)
+{
+    if(options.region || options.deferTileLoading)
+    {
+        setError(TextureImportError::UnsupportedFeature,
+                 "Import regions and deferred tile loading are only supported by the OpenEXR exr backend.");
+        return;
+    }
+
+    // read from memory when the import came from a span or the file can be mapped
+    ExrSource source;
+    MemoryMappedFile mappedFile;
+    source.data = mSourceData;
+
+    if(source.data.empty() && !filePath().empty() && mappedFile.open(filePath())) { source.data = mappedFile.data(); }
+
+    if(source.data.empty())
+    {
+        stream.clear();
+        stream.seekg(0, std::ios_base::end);
+        source.streamSize = static_cast<int64_t>(stream.tellg());
+        source.stream = &stream;
+    }
+
+    exr_context_initializer_t initializer = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    initializer.user_data = &source;
+    initializer.read_fn = readExrSource;
+    initializer.size_fn = queryExrSourceSize;
+    initializer.error_handler_fn = ignoreExrError;
+
+    // Core only uses the name in its messages
+    const std::string filePathStr = filePath().string();
+    exr_context_t context = nullptr;
+
+    if(exr_result_t result =
+           exr_start_read(&context, (!filePathStr.empty()) ? filePathStr.c_str() : "memory", &initializer);
+       result != EXR_ERR_SUCCESS)
+    {
+        setErrorFromExr(result);
+        return;
+    }
+
+    auto scopeCleanup = gsl::finally([&context]() { exr_finish(&context); });
+
+    int partCount = 0;
+
+    if(exr_result_t result = exr_get_count(context, &partCount); result != EXR_ERR_SUCCESS)
+    {
+        setErrorFromExr(result);
+        return;
+    }
+
+    mTextureLayouts.clear();
+    std::vector<PartProperties> partProperties(partCount);
+
+    for(int partIndex = 0; partIndex < partCount; ++partIndex)
+    {
+        if(!readPartProperties(context, partIndex, options.channelFilter, partProperties[partIndex])) { return; }
+    }
+
+    if(mTextureLayouts.empty())
+    {
+        setError(TextureImportError::UnsupportedFeature, "No valid layers or channels.");
+        return;
+    }
+
+    if(!selectLayoutFormats(textureAllocator)) { return; }
+
+    textureAllocator.preAllocation(static_cast<int>(mTextureLayouts.size()));
+
+    for(size_t i = 0; i < mTextureLayouts.size(); ++i)
+    {
+        TextureLayout& layout = mTextureLayouts[i];
+        const PartProperties& properties = partProperties[layout.partIndex];
+
+        cputex::TextureParams params;
+        params.arraySize = 1;
+        params.dimension = cputex::TextureDimension::Texture2D;
+        params.extent = cputex::Extent{properties.extent.x, properties.extent.y, 1};
+        params.faces = 1;
+        params.mips = properties.mips;
+        params.surfaceByteAlignment = 4;
+        params.format = layout.format;
+
+        if(!textureAllocator.allocateTexture(params, static_cast<int>(i)))
+        {
+            setTextureAllocationError(params);
+            return;
+        }
+
+        layout.textureIndex = static_cast<int>(i);
+    }
+
+    textureAllocator.postAllocation();
+
+    decodeChunks(context, partProperties, textureAllocator, resolveThreadCount(options.threadCount));
+}
+
+bool ExrOpenExrCoreImporter::readPartProperties(exr_const_context_t context, int partIndex,
+                                                const std::function<bool(std::string_view)>& channelFilter,
+                                                PartProperties& properties)
+{
+    static constexpr std::array<std::string_view, 4> colorNames = {"r", "g", "b", "a"};
+
+    if(exr_result_t result = exr_get_storage(context, partIndex, &properties.storage); result != EXR_ERR_SUCCESS)
+    {
+        setErrorFromExr(result);
+        return false;
+    }
+
+    if(properties.storage == EXR_STORAGE_DEEP_SCANLINE || properties.storage == EXR_STORAGE_DEEP_TILED)
+    {
+        setError(TextureImportError::UnsupportedFeature, "EXR deep images are not currently supported");
+        return false;
+    }
+
+    exr_attr_box2i_t dataWindow;
+
+    if(exr_result_t result = exr_get_data_window(context, partIndex, &dataWindow); result != EXR_ERR_SUCCESS)
+    {
+        setErrorFromExr(result);
+        return false;
+    }
+
+    properties.dataWindowMin = {dataWindow.min.x, dataWindow.min.y};
+    properties.extent = {dataWindow.max.x - dataWindow.min.x + 1, dataWindow.max.y - dataWindow.min.y + 1};
+
+    if(properties.storage == EXR_STORAGE_TILED)
+    {
+        uint32_t tileWidth = 0;
+        uint32_t tileHeight = 0;
+        exr_tile_level_mode_t levelMode;
+        exr_tile_round_mode_t roundMode;
+        int32_t levelsX = 0;
+        int32_t levelsY = 0;
+
+        exr_result_t result = exr_get_tile_descriptor(context, partIndex, &tileWidth, &tileHeight, &levelMode,
+                                                      &roundMode);
+
+        if(result == EXR_ERR_SUCCESS) { result = exr_get_tile_levels(context, partIndex, &levelsX, &levelsY); }
+
+        if(result != EXR_ERR_SUCCESS)
+        {
+            setErrorFromExr(result);
+            return false;
+        }
+
+        if(levelMode != EXR_TILE_ONE_LEVEL && roundMode == EXR_TILE_ROUND_UP)
+        {
+            setError(TextureImportError::UnsupportedFeature,
+                     "EXR tiled images with level rounding mode 'round up' are not currently supported");
+            return false;
+        }
+
+        // ripmaps are imported as a mip chain made of their levels with matching x and y reductions
+        if(levelMode == EXR_TILE_MIPMAP_LEVELS) { properties.mips = levelsX; }
+        else if(levelMode == EXR_TILE_RIPMAP_LEVELS) { properties.mips = std::min(levelsX, levelsY); }
+
+        properties.chunkSize = {static_cast<int>(tileWidth), static_cast<int>(tileHeight)};
+    }
+    else
+    {
+        int32_t scanlinesPerChunk = 0;
+
+        if(exr_result_t result = exr_get_scanlines_per_chunk(context, partIndex, &scanlinesPerChunk);
+           result != EXR_ERR_SUCCESS)
+        {
+            setErrorFromExr(result);
+            return false;
+        }
+
+        properties.chunkSize = {properties.extent.x, scanlinesPerChunk};
+    }
+
+    const exr_attr_chlist_t* channels = nullptr;
+
+    if(exr_result_t result = exr_get_channels(context, partIndex, &channels); result != EXR_ERR_SUCCESS)
+    {
+        setErrorFromExr(result);
+        return false;
+    }
+
+    properties.channelTargets.assign(channels->num_channels, {-1, -1});
+
+    const size_t firstPartLayout = mTextureLayouts.size();
+
+    for(int channelIndex = 0; channelIndex < channels->num_channels; ++channelIndex)
+    {
+        const exr_attr_chlist_entry_t& channel = channels->entries[channelIndex];
+        const std::string_view fullName{channel.name.str, static_cast<size_t>(channel.name.length)};
+
+        // filtered channels are left without a target, Core skips decoding them
+        if(channelFilter && !channelFilter(fullName)) { continue; }
+
+        if(channel.x_sampling != 1 || channel.y_sampling != 1)
+        {
+            setError(TextureImportError::UnsupportedFeature, "EXR subsampled channels are not currently supported");
+            return false;
+        }
+
+        std::string_view layerName;
+        std::string_view channelName = fullName;
+
+        if(const size_t lastPeriod = fullName.rfind('.'); lastPeriod != std::string_view::npos)
+        {
+            layerName = fullName.substr(0, lastPeriod);
+            channelName = fullName.substr(lastPeriod + 1);
+        }
+
+        auto colorItr = std::find_if(colorNames.begin(), colorNames.end(), [channelName](std::string_view colorName)
+                                     { return caseInsensitiveEqual(channelName, colorName); });
+
+        if(colorItr == colorNames.end())
+        {
+            TextureLayout& layout = mTextureLayouts.emplace_back();
+            layout.partIndex = partIndex;
+            layout.layerName = layerName;
+            layout.channelNames[0] = fullName;
+            layout.channelMask = gpufmt::ChannelMask::Red;
+            layout.pixelType = channel.pixel_type;
+
+            properties.channelTargets[channelIndex] = {static_cast<int>(mTextureLayouts.size()) - 1, 0};
+            continue;
+        }
+
+        // r, g, b and a channels of the same layer and pixel type share a texture
+        const int component = static_cast<int>(std::distance(colorNames.begin(), colorItr));
+        const auto componentMask = static_cast<gpufmt::ChannelMask>(static_cast<uint32_t>(gpufmt::ChannelMask::Red)
+                                                                    << component);
+
+        auto layoutItr = std::find_if(mTextureLayouts.begin() + firstPartLayout, mTextureLayouts.end(),
+                                      [&](const TextureLayout& layout)
+                                      {
+                                          return layout.color && layout.pixelType == channel.pixel_type &&
+                                                 layout.layerName == layerName &&
+                                                 !enumMaskTest(layout.channelMask, componentMask);
+                                      });
+
+        if(layoutItr == mTextureLayouts.end())
+        {
+            TextureLayout& layout = mTextureLayouts.emplace_back();
+            layout.partIndex = partIndex;
+            layout.layerName = layerName;
+            layout.pixelType = channel.pixel_type;
+            layout.color = true;
+
+            layoutItr = mTextureLayouts.end() - 1;
+        }
+
+        layoutItr->channelNames[component] = fullName;
+        layoutItr->channelMask |= componentMask;
+
+        properties.channelTargets[channelIndex] = {static_cast<int>(std::distance(mTextureLayouts.begin(), layoutItr)),
+                                                   component};
+    }
+
+    return true;
+}
+
+bool ExrOpenExrCoreImporter::selectLayoutFormats(ITextureAllocator& textureAllocator)
+{
+    constexpr std::array halfFormatLayouts = {FormatLayout::_16, FormatLayout::_16_16, FormatLayout::_16_16_16,
+                                              FormatLayout::_16_16_16_16};
+    constexpr std::array halfFormats = {gpufmt::Format::R16_SFLOAT, gpufmt::Format::R16G16_SFLOAT,
+                                        gpufmt::Format::R16G16B16_SFLOAT, gpufmt::Format::R16G16B16A16_SFLOAT};
+    constexpr std::array fullFormatLayouts = {FormatLayout::_32, FormatLayout::_32_32, FormatLayout::_32_32_32,
+                                              FormatLayout::_32_32_32_32};
+
+    for(TextureLayout& layout : mTextureLayouts)
+    {
+        const gpufmt::Format nativeFormat = getLayoutFormat(layout);
+        const size_t componentIndex = layoutComponentCount(layout.channelMask) - 1;
+
+        const FormatLayout nativeFormatLayout = (layout.pixelType == EXR_PIXEL_HALF)
+                                                    ? halfFormatLayouts[componentIndex]
+                                                    : fullFormatLayouts[componentIndex];
+
+        // Core converts float channels to half while unpacking, packed formats would need a second pass
+        std::span<const FormatLayout> additionalFormatLayouts;
+
+        if(layout.pixelType == EXR_PIXEL_FLOAT) { additionalFormatLayouts = {&halfFormatLayouts[componentIndex], 1}; }
+
+        const FormatLayout selectedFormatLayout =
+            textureAllocator.selectFormatLayout(nativeFormatLayout, additionalFormatLayouts);
+
+        if(!isValidFormatLayout(nativeFormatLayout, additionalFormatLayouts, selectedFormatLayout))
+        {
+            setTextureAllocatorFormatLayoutError(selectedFormatLayout);
+            return false;
+        }
+
+        const gpufmt::Format layoutFormat =
+            (selectedFormatLayout == nativeFormatLayout) ? nativeFormat : halfFormats[componentIndex];
+
+        const std::array availableFormats = {layoutFormat};
+        const gpufmt::Format format = textureAllocator.selectFormat(selectedFormatLayout, availableFormats);
+
+        if(!contains(availableFormats, format))
+        {
+            setTextureAllocatorFormatError(format);
+            return false;
+        }
+
+        layout.format = format;
+    }
+
+    return true;
+}
+
+bool ExrOpenExrCoreImporter::decodeChunks(exr_const_context_t context, std::span<const PartProperties> partProperties,
+                                          ITextureAllocator& textureAllocator, int threadCount)
+{
+    struct Chunk
+    {
+        int partIndex = 0;
+        int mip = 0;
+        // tile coordinates, or the first scanline of the block relative to the data window
+        int x = 0;
+        int y = 0;
+    };
+
+    std::vector<Chunk> chunks;
+
+    for(int partIndex = 0; partIndex < static_cast<int>(partProperties.size()); ++partIndex)
+    {
+        const PartProperties& properties = partProperties[partIndex];
+
+        const bool hasTargets =
+            std::any_of(properties.channelTargets.begin(), properties.channelTargets.end(),
+                        [](const std::array<int, 2>& channelTarget) { return channelTarget[0] >= 0; });
+
+        if(!hasTargets) { continue; }
+
+        if(properties.storage != EXR_STORAGE_TILED)
+        {
+            for(int y = 0; y < properties.extent.y; y += properties.chunkSize.y)
+            {
+                chunks.emplace_back(Chunk{partIndex, 0, 0, y});
+            }
+
+            continue;
+        }
+
+        for(int mip = 0; mip < properties.mips; ++mip)
+        {
+            int32_t tileCountX = 0;
+            int32_t tileCountY = 0;
+
+            if(exr_result_t result = exr_get_tile_counts(context, partIndex, mip, mip, &tileCountX, &tileCountY);
+               result != EXR_ERR_SUCCESS)
+            {
+                setErrorFromExr(result);
+                return false;
+            }
+
+            for(int tileY = 0; tileY < tileCountY; ++tileY)
+            {
+                for(int tileX = 0; tileX < tileCountX; ++tileX)
+                {
+                    chunks.emplace_back(Chunk{partIndex, mip, tileX, tileY});
+                }
+            }
+        }
+    }
+
+    // surfaces are looked up up front, the allocator is never called from the workers
+    std::vector<std::vector<std::span<std::byte>>> surfaces(mTextureLayouts.size());
+
+    for(size_t i = 0; i < mTextureLayouts.size(); ++i)
+    {
+        const int mips = partProperties[mTextureLayouts[i].partIndex].mips;
+
+        for(int mip = 0; mip < mips; ++mip)
+        {
+            surfaces[i].emplace_back(textureAllocator.accessTextureData(
+                mTextureLayouts[i].textureIndex, MipSurfaceKey{.arraySlice = 0, .face = 0, .mip = (int8_t)mip}));
+        }
+    }
+
+    // every worker keeps one decode pipeline and rebuilds it when it moves on to a chunk of another part. Core's
+    // context is safe to read chunks from concurrently.
+    const int workerCount = std::min(threadCount, static_cast<int>(chunks.size()));
+    std::atomic<int> nextChunk{0};
+    std::vector<std::string> workerErrors(workerCount);
+
+    parallelFor(workerCount, workerCount,
+                [&](int worker)
+                {
+                    exr_decode_pipeline_t decoder = EXR_DECODE_PIPELINE_INITIALIZER;
+                    int decoderPartIndex = -1;
+
+                    auto decoderCleanup = gsl::finally(
+                        [&]()
+                        {
+                            if(decoderPartIndex >= 0) { exr_decoding_destroy(context, &decoder); }
+                        });
+
+                    for(int i = nextChunk++; i < static_cast<int>(chunks.size()); i = nextChunk++)
+                    {
+                        const Chunk& chunk = chunks[i];
+                        const PartProperties& properties = partProperties[chunk.partIndex];
+
+                        exr_chunk_info_t chunkInfo;
+                        exr_result_t result = EXR_ERR_SUCCESS;
+
+                        if(properties.storage == EXR_STORAGE_TILED)
+                        {
+                            result = exr_read_tile_chunk_info(context, chunk.partIndex, chunk.x, chunk.y, chunk.mip,
+                                                              chunk.mip, &chunkInfo);
+                        }
+                        else
+                        {
+                            result = exr_read_scanline_chunk_info(
+                                context, chunk.partIndex, properties.dataWindowMin.y + chunk.y, &chunkInfo);
+                        }
+
+                        if(result == EXR_ERR_SUCCESS)
+                        {
+                            if(decoderPartIndex == chunk.partIndex)
+                            {
+                                result = exr_decoding_update(context, chunk.partIndex, &chunkInfo, &decoder);
+                            }
+                            else
+                            {
+                                if(decoderPartIndex >= 0) { exr_decoding_destroy(context, &decoder); }
+
+                                decoder = EXR_DECODE_PIPELINE_INITIALIZER;
+                                decoderPartIndex = -1;
+
+                                result = exr_decoding_initialize(context, chunk.partIndex, &chunkInfo, &decoder);
+
+                                if(result == EXR_ERR_SUCCESS) { decoderPartIndex = chunk.partIndex; }
+                            }
+                        }
+
+                        if(result != EXR_ERR_SUCCESS)
+                        {
+                            workerErrors[worker] = exr_get_default_error_message(result);
+                            return;
+                        }
+
+                        // position of the chunk in its mip
+                        glm::ivec2 chunkMin{0, chunk.y};
+
+                        if(properties.storage == EXR_STORAGE_TILED)
+                        {
+                            chunkMin = {chunk.x * properties.chunkSize.x, chunk.y * properties.chunkSize.y};
+                        }
+
+                        const cputex::Extent mipExtent = cputex::calculateMipExtent(
+                            cputex::Extent{properties.extent.x, properties.extent.y, 1}, chunk.mip);
+
+                        if(chunkMin.x + chunkInfo.width > static_cast<int>(mipExtent.x) ||
+                           chunkMin.y + chunkInfo.height > static_cast<int>(mipExtent.y))
+                        {
+                            workerErrors[worker] = "EXR chunk lies outside of its level.";
+                            return;
+                        }
+
+                        // point every imported channel straight at its component in the texture
+                        for(int channelIndex = 0; channelIndex < decoder.channel_count; ++channelIndex)
+                        {
+                            exr_coding_channel_info_t& decodeChannel = decoder.channels[channelIndex];
+                            const std::array<int, 2>& channelTarget = properties.channelTargets[channelIndex];
+
+                            if(channelTarget[0] < 0)
+                            {
+                                decodeChannel.decode_to_ptr = nullptr;
+                                continue;
+                            }
+
+                            const TextureLayout& layout = mTextureLayouts[channelTarget[0]];
+                            const gpufmt::FormatInfo& formatInfo = gpufmt::formatInfo(layout.format);
+                            const int32_t componentSize = formatInfo.blockByteSize / formatInfo.componentCount;
+                            const int32_t pixelStride = formatInfo.blockByteSize;
+                            const int32_t lineStride = pixelStride * static_cast<int32_t>(mipExtent.x);
+
+                            std::byte* componentData =
+                                surfaces[channelTarget[0]][chunk.mip].data() + size_t(chunkMin.y) * lineStride +
+                                size_t(chunkMin.x) * pixelStride + size_t(channelTarget[1]) * componentSize;
+
+                            decodeChannel.decode_to_ptr = reinterpret_cast<uint8_t*>(componentData);
+                            decodeChannel.user_pixel_stride = pixelStride;
+                            decodeChannel.user_line_stride = lineStride;
+                            decodeChannel.user_bytes_per_element = static_cast<int16_t>(componentSize);
+
+                            if(layout.pixelType == EXR_PIXEL_UINT) { decodeChannel.user_data_type = EXR_PIXEL_UINT; }
+                            else
+                            {
+                                decodeChannel.user_data_type = (componentSize == 2) ? EXR_PIXEL_HALF : EXR_PIXEL_FLOAT;
+                            }
+                        }
+
+                        // the unpack routine depends on the destination layout, so it's picked again for every chunk
+                        result = exr_decoding_choose_default_routines(context, chunk.partIndex, &decoder);
+
+                        if(result == EXR_ERR_SUCCESS) { result = exr_decoding_run(context, chunk.partIndex, &decoder); }
+
+                        if(result != EXR_ERR_SUCCESS)
+                        {
+                            workerErrors[worker] = exr_get_default_error_message(result);
+                            return;
+                        }
+                    }
+                });
+
+    for(std::string& workerError : workerErrors)
+    {
+        if(!workerError.empty())
+        {
+            setError(TextureImportError::InvalidDataInImage, std::move(workerError));
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace teximp::exr
+
+#endif // TEXIMP_ENABLE_EXR_BACKEND_OPENEXR_CORE
@@ -2,12 +2,475 @@
 
 #ifdef TEXIMP_ENABLE_JPEG_BACKEND_LIBJPEG_TURBO
 
+#include "utilities.h"
+
+// jpeglib.h expects FILE and size_t to be declared
+#include <cstdio>
+#include <jpeglib.h>
+#include <jerror.h>
 #include <turbojpeg.h>
 
-#include <gsl/gsl-lite.hpp>
+#include <algorithm>
+#include <csetjmp>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <string>
 
 namespace teximp::jpeg
 {
+// Creating a turbojpeg decompressor sets up a complete libjpeg decompress object, which is a noticeable part of the
+// import time for small images. One handle is kept per thread instead, turbojpeg resets its state at the start of each
+// decompress call so a handle can be reused even after a failed decode.
+[[nodiscard]] tjhandle threadDecompressHandle()
+{
+    struct DecompressHandle
+    {
+        tjhandle handle = tjInitDecompress();
+
+        ~DecompressHandle()
+        {
+            if(handle != nullptr) { tjDestroy(handle); }
+        }
+    };
+
+    thread_local DecompressHandle decompressHandle;
+
+    return decompressHandle.handle;
+}
+
+// libjpeg-turbo can scale by 1/2, 1/4 and 1/8 while decoding, smaller levels are downsampled from the previous level
+constexpr int kMaxDctScaledLevel = 3;
+
+[[nodiscard]] int calculateMipCount(int width, int height)
+{
+    int mipCount = 1;
+
+    for(int size = std::max(width, height); size > 1; size /= 2)
+    {
+        ++mipCount;
+    }
+
+    return mipCount;
+}
+
+// Smallest level the DCT scaling can decode that still covers a thumbnail of thumbnailSize.
+[[nodiscard]] int calculateThumbnailDctLevel(int width, int height, int thumbnailSize)
+{
+    return calculateThumbnailLevel(width, height, thumbnailSize,
+                                   std::min(kMaxDctScaledLevel + 1, calculateMipCount(width, height)));
+}
+
+// 2x2 box filter of 8 bit channels. Odd source dimensions drop their last row or column like the mip extents do.
+void downsampleMip(std::span<const std::byte> source, cputex::Extent sourceExtent, std::span<std::byte> destination,
+                   cputex::Extent destinationExtent, size_t pixelByteSize)
+{
+    const size_t sourceRowPitch = sourceExtent.x * pixelByteSize;
+    const size_t destinationRowPitch = destinationExtent.x * pixelByteSize;
+
+    for(int y = 0; y < destinationExtent.y; ++y)
+    {
+        const int y0 = std::min(y * 2, sourceExtent.y - 1);
+        const int y1 = std::min(y * 2 + 1, sourceExtent.y - 1);
+
+        for(int x = 0; x < destinationExtent.x; ++x)
+        {
+            const int x0 = std::min(x * 2, sourceExtent.x - 1);
+            const int x1 = std::min(x * 2 + 1, sourceExtent.x - 1);
+
+            for(size_t channel = 0; channel < pixelByteSize; ++channel)
+            {
+                const uint32_t sum = static_cast<uint32_t>(source[y0 * sourceRowPitch + x0 * pixelByteSize + channel]) +
+                                     static_cast<uint32_t>(source[y0 * sourceRowPitch + x1 * pixelByteSize + channel]) +
+                                     static_cast<uint32_t>(source[y1 * sourceRowPitch + x0 * pixelByteSize + channel]) +
+                                     static_cast<uint32_t>(source[y1 * sourceRowPitch + x1 * pixelByteSize + channel]);
+
+                destination[y * destinationRowPitch + x * pixelByteSize + channel] = static_cast<std::byte>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+//---------------------------------
+// Restart interval parallel decode
+//---------------------------------
+
+// Below this size the cost of splitting the file outweighs decoding on more threads.
+constexpr int kMinParallelDecodePixelCount = 1024 * 1024;
+
+struct JpegRestartLayout
+{
+    // everything from SOI up to the first byte of entropy coded data
+    std::span<const uint8_t> header;
+    // offset of the 16 bit image height inside the SOF segment of header
+    size_t frameHeightOffset = 0;
+    // entropy coded data of each restart interval, without the RST markers between them
+    std::vector<std::span<const uint8_t>> intervals;
+    bool verticallySubsampled = false;
+    int mcuHeight = 0;
+    int mcuRowCount = 0;
+    int intervalsPerMcuRow = 0;
+};
+
+[[nodiscard]] uint16_t readUInt16BigEndian(std::span<const uint8_t> bytes, size_t offset)
+{
+    return static_cast<uint16_t>((bytes[offset] << 8) | bytes[offset + 1]);
+}
+
+// Collects the restart intervals of single scan sequential huffman jpegs whose intervals start on mcu row boundaries.
+// Each band of mcu rows can then be decoded as an image of its own.
+[[nodiscard]] std::optional<JpegRestartLayout> parseRestartLayout(std::span<const uint8_t> data)
+{
+    JpegRestartLayout layout;
+
+    int width = 0;
+    int height = 0;
+    int componentCount = 0;
+    int maxHorizontalSampling = 1;
+    int maxVerticalSampling = 1;
+    int minVerticalSampling = 4;
+    int restartInterval = 0;
+    size_t scanStart = 0;
+    size_t pos = 2;
+
+    while(scanStart == 0)
+    {
+        if(pos + 4 > data.size() || data[pos] != 0xFF) { return std::nullopt; }
+
+        while(pos < data.size() && data[pos] == 0xFF)
+        {
+            ++pos;
+        }
+
+        if(pos + 3 > data.size()) { return std::nullopt; }
+
+        const uint8_t marker = data[pos++];
+        const size_t segmentLength = readUInt16BigEndian(data, pos);
+
+        if(segmentLength < 2 || pos + segmentLength > data.size()) { return std::nullopt; }
+
+        const std::span<const uint8_t> segment = data.subspan(pos, segmentLength);
+
+        if(marker == 0xC0 || marker == 0xC1)
+        {
+            // baseline and extended sequential huffman
+            if(segmentLength < 8 || segment[2] != 8) { return std::nullopt; }
+
+            layout.frameHeightOffset = pos + 3;
+            height = readUInt16BigEndian(segment, 3);
+            width = readUInt16BigEndian(segment, 5);
+            componentCount = segment[7];
+
+            if(componentCount == 0 || segmentLength < 8 + size_t(componentCount) * 3) { return std::nullopt; }
+
+            for(int i = 0; i < componentCount; ++i)
+            {
+                const uint8_t sampling = segment[9 + i * 3];
+
+                maxHorizontalSampling = std::max(maxHorizontalSampling, sampling >> 4);
+                maxVerticalSampling = std::max(maxVerticalSampling, sampling & 0xF);
+                minVerticalSampling = std::min(minVerticalSampling, sampling & 0xF);
+            }
+        }
+        else if((marker >= 0xC2 && marker <= 0xCF) && marker != 0xC4 && marker != 0xC8)
+        {
+            // progressive, lossless, hierarchical or arithmetic coded
+            return std::nullopt;
+        }
+        else if(marker == 0xDD)
+        {
+            if(segmentLength != 4) { return std::nullopt; }
+
+            restartInterval = readUInt16BigEndian(segment, 2);
+        }
+        else if(marker == 0xDA)
+        {
+            // only a scan that holds every component decodes the whole image
+            if(componentCount == 0 || segment[2] != componentCount) { return std::nullopt; }
+
+            scanStart = pos + segmentLength;
+        }
+        else if(marker == 0xD9) { return std::nullopt; }
+
+        pos += segmentLength;
+    }
+
+    if(restartInterval == 0 || width == 0 || height == 0) { return std::nullopt; }
+
+    const int mcuWidth = (componentCount == 1) ? 8 : 8 * maxHorizontalSampling;
+    layout.mcuHeight = (componentCount == 1) ? 8 : 8 * maxVerticalSampling;
+    layout.verticallySubsampled = componentCount > 1 && minVerticalSampling != maxVerticalSampling;
+
+    const int mcusPerRow = (width + mcuWidth - 1) / mcuWidth;
+    layout.mcuRowCount = (height + layout.mcuHeight - 1) / layout.mcuHeight;
+
+    if(mcusPerRow % restartInterval != 0) { return std::nullopt; }
+
+    layout.intervalsPerMcuRow = mcusPerRow / restartInterval;
+    layout.header = data.subspan(0, scanStart);
+    layout.intervals.reserve(size_t(layout.intervalsPerMcuRow) * layout.mcuRowCount);
+
+    size_t intervalStart = scanStart;
+
+    for(pos = scanStart; pos + 1 < data.size(); ++pos)
+    {
+        if(data[pos] != 0xFF) { continue; }
+
+        const uint8_t marker = data[pos + 1];
+
+        // stuffed zero byte or fill byte
+        if(marker == 0x00 || marker == 0xFF) { continue; }
+
+        layout.intervals.push_back(data.subspan(intervalStart, pos - intervalStart));
+
+        if(marker >= 0xD0 && marker <= 0xD7)
+        {
+            if(size_t(marker - 0xD0) != (layout.intervals.size() - 1) % 8) { return std::nullopt; }
+
+            intervalStart = pos + 2;
+            ++pos;
+            continue;
+        }
+
+        // anything but EOI means there is more than one scan
+        if(marker != 0xD9) { return std::nullopt; }
+
+        break;
+    }
+
+    if(layout.intervals.size() != size_t(layout.intervalsPerMcuRow) * layout.mcuRowCount) { return std::nullopt; }
+
+    return layout;
+}
+
+// Builds a standalone jpeg holding the mcu rows [firstMcuRow, endMcuRow).
+[[nodiscard]] std::vector<uint8_t> buildBandJpeg(const JpegRestartLayout& layout, int firstMcuRow, int endMcuRow,
+                                                 int bandHeight)
+{
+    const size_t firstInterval = size_t(firstMcuRow) * layout.intervalsPerMcuRow;
+    const size_t endInterval = size_t(endMcuRow) * layout.intervalsPerMcuRow;
+
+    size_t byteSize = layout.header.size() + 2;
+
+    for(size_t i = firstInterval; i < endInterval; ++i)
+    {
+        byteSize += layout.intervals[i].size() + 2;
+    }
+
+    std::vector<uint8_t> band;
+    band.reserve(byteSize);
+    band.insert(band.end(), layout.header.begin(), layout.header.end());
+
+    band[layout.frameHeightOffset] = static_cast<uint8_t>(bandHeight >> 8);
+    band[layout.frameHeightOffset + 1] = static_cast<uint8_t>(bandHeight);
+
+    for(size_t i = firstInterval; i < endInterval; ++i)
+    {
+        if(i != firstInterval)
+        {
+            // restart markers count from RST0 again in every band
+            band.push_back(0xFF);
+            band.push_back(static_cast<uint8_t>(0xD0 + (i - firstInterval - 1) % 8));
+        }
+
+        band.insert(band.end(), layout.intervals[i].begin(), layout.intervals[i].end());
+    }
+
+    band.push_back(0xFF);
+    band.push_back(0xD9);
+
+    return band;
+}
+
+// Decodes bands of mcu rows on separate threads straight into the output. Fancy upsampling of vertically subsampled
+// chroma looks at the neighbouring chroma rows, so those bands are decoded with one extra mcu row above and below into
+// a band buffer and only their own rows are copied out. Every row then matches a single threaded decode.
+[[nodiscard]] bool decodeRestartBands(const JpegRestartLayout& layout, int width, int height, unsigned char* output,
+                                      int pitch, TJPF pixelFormat, int threadCount, std::string& errorMessage)
+{
+    const int bandCount = std::min(threadCount, layout.mcuRowCount);
+    const int overlapMcuRows = (layout.verticallySubsampled) ? 1 : 0;
+    const size_t rowByteSize = size_t(width) * tjPixelSize[pixelFormat];
+
+    std::vector<std::string> bandErrors(bandCount);
+
+    parallelFor(bandCount, threadCount,
+                [&](int band)
+                {
+                    const int firstMcuRow = layout.mcuRowCount * band / bandCount;
+                    const int endMcuRow = layout.mcuRowCount * (band + 1) / bandCount;
+                    const int firstRow = firstMcuRow * layout.mcuHeight;
+                    const int bandHeight = std::min(endMcuRow * layout.mcuHeight, height) - firstRow;
+
+                    const int decodeFirstMcuRow = std::max(firstMcuRow - overlapMcuRows, 0);
+                    const int decodeEndMcuRow = std::min(endMcuRow + overlapMcuRows, layout.mcuRowCount);
+                    const int decodeFirstRow = decodeFirstMcuRow * layout.mcuHeight;
+                    const int decodeHeight = std::min(decodeEndMcuRow * layout.mcuHeight, height) - decodeFirstRow;
+
+                    // parallelFor's func must not throw
+                    try
+                    {
+                        const std::vector<uint8_t> bandJpeg =
+                            buildBandJpeg(layout, decodeFirstMcuRow, decodeEndMcuRow, decodeHeight);
+
+                        tjhandle handle = threadDecompressHandle();
+
+                        if(handle == nullptr)
+                        {
+                            bandErrors[band] = tjGetErrorStr();
+                            return;
+                        }
+
+                        if(decodeHeight == bandHeight)
+                        {
+                            if(tjDecompress2(handle, bandJpeg.data(), (unsigned long)bandJpeg.size(),
+                                             output + size_t(firstRow) * pitch, width, pitch, bandHeight, pixelFormat,
+                                             0) != 0)
+                            {
+                                bandErrors[band] = tjGetErrorStr2(handle);
+                            }
+
+                            return;
+                        }
+
+                        std::vector<unsigned char> bandPixels(rowByteSize * decodeHeight);
+
+                        if(tjDecompress2(handle, bandJpeg.data(), (unsigned long)bandJpeg.size(), bandPixels.data(),
+                                         width, (int)rowByteSize, decodeHeight, pixelFormat, 0) != 0)
+                        {
+                            bandErrors[band] = tjGetErrorStr2(handle);
+                            return;
+                        }
+
+                        for(int row = 0; row < bandHeight; ++row)
+                        {
+                            std::memcpy(output + size_t(firstRow + row) * pitch,
+                                        bandPixels.data() + size_t(firstRow - decodeFirstRow + row) * rowByteSize,
+                                        rowByteSize);
+                        }
+                    }
+                    catch(const std::bad_alloc&)
+                    {
+                        bandErrors[band] = "Out of memory.";
+                    }
+                });
+
+    for(std::string& bandError : bandErrors)
+    {
+        if(!bandError.empty())
+        {
+            errorMessage = std::move(bandError);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+[[nodiscard]] TJPF toPixelFormat(gpufmt::Format format)
+{
+    switch(format)
+    {
+    case gpufmt::Format::R8_SRGB: [[fallthrough]];
+    case gpufmt::Format::R8_UNORM: return TJPF_GRAY;
+    case gpufmt::Format::R8G8B8_SRGB: [[fallthrough]];
+    case gpufmt::Format::R8G8B8_UNORM: return TJPF_RGB;
+    case gpufmt::Format::B8G8R8_SRGB: [[fallthrough]];
+    case gpufmt::Format::B8G8R8_UNORM: return TJPF_BGR;
+    case gpufmt::Format::R8G8B8A8_SRGB: [[fallthrough]];
+    case gpufmt::Format::R8G8B8A8_UNORM: return TJPF_RGBA;
+    case gpufmt::Format::B8G8R8X8_SRGB: [[fallthrough]];
+    case gpufmt::Format::B8G8R8X8_UNORM: return TJPF_BGRX;
+    case gpufmt::Format::B8G8R8A8_SRGB: [[fallthrough]];
+    case gpufmt::Format::B8G8R8A8_UNORM: return TJPF_BGRA;
+    case gpufmt::Format::A8B8G8R8_SRGB_PACK32: [[fallthrough]];
+    case gpufmt::Format::A8B8G8R8_UNORM_PACK32: return TJPF_ABGR;
+    default: return TJPF_RGBA;
+    }
+}
+
+//---------------------------------
+// Streaming decode
+//---------------------------------
+
+// Reads the compressed data from the stream through a fixed size buffer instead of loading the whole file.
+struct StreamSourceManager
+{
+    jpeg_source_mgr pub;
+    std::istream* stream = nullptr;
+    std::array<JOCTET, 16 * 1024> buffer;
+};
+
+struct StreamErrorManager
+{
+    jpeg_error_mgr pub;
+    std::jmp_buf jumpBuffer;
+    std::array<char, JMSG_LENGTH_MAX> message;
+};
+
+void initStreamSource(StreamSourceManager& sourceManager, std::istream& stream)
+{
+    sourceManager.stream = &stream;
+    sourceManager.pub.next_input_byte = nullptr;
+    sourceManager.pub.bytes_in_buffer = 0;
+    sourceManager.pub.init_source = [](j_decompress_ptr) {};
+    sourceManager.pub.term_source = [](j_decompress_ptr) {};
+    sourceManager.pub.resync_to_restart = jpeg_resync_to_restart;
+
+    sourceManager.pub.fill_input_buffer = [](j_decompress_ptr decompress) -> boolean
+    {
+        StreamSourceManager& sourceManager = *reinterpret_cast<StreamSourceManager*>(decompress->src);
+
+        sourceManager.stream->read(reinterpret_cast<char*>(sourceManager.buffer.data()), sourceManager.buffer.size());
+        size_t bytesRead = static_cast<size_t>(sourceManager.stream->gcount());
+
+        if(bytesRead == 0)
+        {
+            // a truncated file decodes as far as it goes, same as libjpeg's own stdio source
+            WARNMS(decompress, JWRN_JPEG_EOF);
+            sourceManager.buffer[0] = 0xFF;
+            sourceManager.buffer[1] = JPEG_EOI;
+            bytesRead = 2;
+        }
+
+        sourceManager.pub.next_input_byte = sourceManager.buffer.data();
+        sourceManager.pub.bytes_in_buffer = bytesRead;
+
+        return TRUE;
+    };
+
+    sourceManager.pub.skip_input_data = [](j_decompress_ptr decompress, long byteCount)
+    {
+        jpeg_source_mgr& source = *decompress->src;
+
+        while(byteCount > static_cast<long>(source.bytes_in_buffer))
+        {
+            byteCount -= static_cast<long>(source.bytes_in_buffer);
+            source.fill_input_buffer(decompress);
+        }
+
+        if(byteCount > 0)
+        {
+            source.next_input_byte += byteCount;
+            source.bytes_in_buffer -= byteCount;
+        }
+    };
+}
+
+[[nodiscard]] J_COLOR_SPACE toColorSpace(TJPF pixelFormat)
+{
+    switch(pixelFormat)
+    {
+    case TJPF_GRAY: return JCS_GRAYSCALE;
+    case TJPF_RGB: return JCS_EXT_RGB;
+    case TJPF_BGR: return JCS_EXT_BGR;
+    case TJPF_BGRX: return JCS_EXT_BGRX;
+    case TJPF_BGRA: return JCS_EXT_BGRA;
+    case TJPF_ABGR: return JCS_EXT_ABGR;
+    default: return JCS_EXT_RGBA;
+    }
+}
+
 FileFormat JpegLibJpegTurboImporter::fileFormat() const
 {
     return FileFormat::Jpeg;
@@ -26,6 +489,13 @@ bool JpegLibJpegTurboImporter::checkSignature(std::istream& stream)
 void JpegLibJpegTurboImporter::load(std::istream& stream, ITextureAllocator& textureAllocator,
                                     TextureImportOptions options)
 {
+    if(options.streamingDecode && !options.yuvPlanarOutput && options.reduceLevels <= kMaxDctScaledLevel)
+    {
+        if(loadStreaming(stream, textureAllocator, options)) { return; }
+
+        stream.clear();
+    }
+
     stream.seekg(0, std::ios_base::end);
     unsigned long jpegSize = (unsigned long)stream.tellg();
     stream.seekg(0, std::ios_base::beg);
@@ -44,9 +514,13 @@ void JpegLibJpegTurboImporter::load(std::istream& stream, ITextureAllocator& tex
     int subsamp;
     int colorspace;
 
-    tjhandle handle = tjInitDecompress();
+    tjhandle handle = threadDecompressHandle();
 
-    auto scopeExit = gsl::finally([&]() { tjDestroy(handle); });
+    if(handle == nullptr)
+    {
+        setError(TextureImportError::Unknown, tjGetErrorStr());
+        return;
+    }
 
     int result = tjDecompressHeader3(handle, imageData.data(), jpegSize, &width, &height, &subsamp, &colorspace);
     if(result != 0)
@@ -55,9 +529,169 @@ void JpegLibJpegTurboImporter::load(std::istream& stream, ITextureAllocator& tex
         return;
     }
 
+    // cmyk images have no YCbCr planes and go through the regular rgb decode
+    if(options.yuvPlanarOutput && colorspace != TJCS_CMYK && colorspace != TJCS_YCCK)
+    {
+        if(options.reduceLevels > 0 || options.generateMips || options.thumbnailSize > 0)
+        {
+            setError(TextureImportError::UnsupportedFeature,
+                     "YUV planar output can't be combined with reduceLevels, generateMips or thumbnailSize.");
+            return;
+        }
+
+        loadYuvPlanes(handle, imageData, width, height, subsamp, textureAllocator);
+        return;
+    }
+
+    const gpufmt::Format gpuFormat = selectFormat(textureAllocator, options, colorspace == TJCS_GRAY);
+
+    if(gpuFormat == gpufmt::Format::UNDEFINED) { return; }
+
+    const TJPF jpegFormat = toPixelFormat(gpuFormat);
+
+    // thumbnails only use the scaling the DCT gives for free
+    if(options.thumbnailSize > 0)
+    {
+        options.reduceLevels =
+            std::max(options.reduceLevels, calculateThumbnailDctLevel(width, height, options.thumbnailSize));
+    }
+
+    const cputex::Extent fullExtent{width, height, 1};
+    const int reduceLevels = std::clamp(options.reduceLevels, 0, calculateMipCount(width, height) - 1);
+    const cputex::Extent baseExtent = cputex::calculateMipExtent(fullExtent, reduceLevels);
+
+    cputex::TextureParams params{
+        .format = gpuFormat,
+        .dimension = cputex::TextureDimension::Texture2D,
+        .extent = baseExtent,
+        .arraySize = 1,
+        .faces = 1,
+        .mips = (options.generateMips) ? (cputex::CountType)calculateMipCount(baseExtent.x, baseExtent.y) : 1
+    };
+
+    textureAllocator.preAllocation(1);
+    if(!textureAllocator.allocateTexture(params, 0))
+    {
+        setTextureAllocationError(params);
+        return;
+    }
+
+    textureAllocator.postAllocation();
+
+    const size_t pixelByteSize = gpufmt::formatInfo(gpuFormat).blockByteSize;
+    const int threadCount = resolveThreadCount(options.threadCount);
+    std::vector<std::byte> scaledBuffer;
+
+    for(cputex::CountType mip = 0; mip < params.mips; ++mip)
+    {
+        const int level = reduceLevels + mip;
+        const cputex::Extent mipExtent = cputex::calculateMipExtent(fullExtent, level);
+
+        std::span<std::byte> mipData =
+            textureAllocator.accessTextureData(0, MipSurfaceKey{.arraySlice = 0, .face = 0, .mip = (int8_t)mip});
+
+        if(level > kMaxDctScaledLevel)
+        {
+            const cputex::Extent previousExtent = cputex::calculateMipExtent(fullExtent, level - 1);
+            std::span<const std::byte> previousMipData =
+                textureAllocator.accessTextureData(0, MipSurfaceKey{.arraySlice = 0, .face = 0, .mip = (int8_t)(mip - 1)});
+
+            downsampleMip(previousMipData, previousExtent, mipData, mipExtent, pixelByteSize);
+            continue;
+        }
+
+        // the scaled decode rounds up while mip extents round down, so odd sizes decode one pixel too many
+        const tjscalingfactor scalingFactor{1, 1 << level};
+        const int scaledWidth = TJSCALED(width, scalingFactor);
+        const int scaledHeight = TJSCALED(height, scalingFactor);
+        const bool exactFit = scaledWidth == mipExtent.x && scaledHeight == mipExtent.y;
+
+        std::span<std::byte> decodeData = mipData;
+
+        if(!exactFit)
+        {
+            scaledBuffer.resize(scaledWidth * scaledHeight * pixelByteSize);
+            decodeData = scaledBuffer;
+        }
+
+        if(level == 0 && threadCount > 1 && width * height >= kMinParallelDecodePixelCount)
+        {
+            if(std::optional<JpegRestartLayout> restartLayout = parseRestartLayout(imageData))
+            {
+                std::string errorMessage;
+
+                if(!decodeRestartBands(*restartLayout, width, height,
+                                       castWritableBytes<unsigned char>(decodeData).data(), (int)pixelByteSize * width,
+                                       jpegFormat, threadCount, errorMessage))
+                {
+                    setError(TextureImportError::Unknown, std::move(errorMessage));
+                    return;
+                }
+
+                continue;
+            }
+        }
+
+        result = tjDecompress2(handle, imageData.data(), jpegSize, castWritableBytes<unsigned char>(decodeData).data(),
+                               scaledWidth, (int)pixelByteSize * scaledWidth, scaledHeight, jpegFormat, 0);
+        if(result != 0)
+        {
+            setError(TextureImportError::Unknown, tjGetErrorStr());
+            return;
+        }
+
+        if(!exactFit)
+        {
+            const size_t mipRowPitch = mipExtent.x * pixelByteSize;
+
+            for(int y = 0; y < mipExtent.y; ++y)
+            {
+                std::memcpy(mipData.data() + y * mipRowPitch, scaledBuffer.data() + y * scaledWidth * pixelByteSize,
+                            mipRowPitch);
+            }
+        }
+    }
+}
+
+gpufmt::Format JpegLibJpegTurboImporter::selectFormat(ITextureAllocator& textureAllocator,
+                                                      TextureImportOptions options, bool grayscale)
+{
+    bool decodeGray = false;
+
+    if(grayscale)
+    {
+        // grayscale images stay single channel if the allocator takes 8 bit single channel formats
+        constexpr std::array additionalFormatLayouts = {FormatLayout::_8_8_8_8};
+
+        const FormatLayout selectedFormatLayout =
+            textureAllocator.selectFormatLayout(FormatLayout::_8, additionalFormatLayouts);
+
+        if(!isValidFormatLayout(FormatLayout::_8, std::span(additionalFormatLayouts), selectedFormatLayout))
+        {
+            setTextureAllocatorFormatLayoutError(selectedFormatLayout);
+            return gpufmt::Format::UNDEFINED;
+        }
+
+        decodeGray = selectedFormatLayout == FormatLayout::_8;
+    }
+
     gpufmt::Format gpuFormat;
 
-    if(options.padRgbWithAlpha)
+    if(decodeGray)
+    {
+        std::array availableFormats = {
+            (options.assumeSrgb) ? gpufmt::Format::R8_SRGB : gpufmt::Format::R8_UNORM, // TJPF_GRAY
+        };
+
+        gpuFormat = textureAllocator.selectFormat(FormatLayout::_8, availableFormats);
+
+        if(!contains(availableFormats, gpuFormat))
+        {
+            setTextureAllocatorFormatError(gpuFormat);
+            return gpufmt::Format::UNDEFINED;
+        }
+    }
+    else if(options.padRgbWithAlpha)
     {
         TJPF_ABGR;
         gpufmt::Format::A8B8G8R8_UNORM_PACK32;
@@ -81,6 +715,12 @@ void JpegLibJpegTurboImporter::load(std::istream& stream, ITextureAllocator& tex
         };
 
         gpuFormat = textureAllocator.selectFormat(FormatLayout::_8_8_8_8, availableFormats);
+
+        if(!contains(availableFormats, gpuFormat))
+        {
+            setTextureAllocatorFormatError(gpuFormat);
+            return gpufmt::Format::UNDEFINED;
+        }
     }
     else
     {
@@ -95,55 +735,233 @@ void JpegLibJpegTurboImporter::load(std::istream& stream, ITextureAllocator& tex
         };
 
         gpuFormat = textureAllocator.selectFormat(FormatLayout::_8_8_8_8, availableFormats);
+
+        if(!contains(availableFormats, gpuFormat))
+        {
+            setTextureAllocatorFormatError(gpuFormat);
+            return gpufmt::Format::UNDEFINED;
+        }
+    }
+
+    return gpuFormat;
+}
+
+bool JpegLibJpegTurboImporter::loadStreaming(std::istream& stream, ITextureAllocator& textureAllocator,
+                                             TextureImportOptions options)
+{
+    stream.seekg(0);
+
+    // Everything with a destructor lives outside the setjmp scope, libjpeg errors longjmp back past it.
+    StreamSourceManager sourceManager;
+    StreamErrorManager errorManager;
+    std::vector<std::byte> rowBuffer;
+    jpeg_decompress_struct decompress;
+
+    initStreamSource(sourceManager, stream);
+
+    decompress.err = jpeg_std_error(&errorManager.pub);
+    errorManager.pub.error_exit = [](j_common_ptr info)
+    {
+        StreamErrorManager& errorManager = *reinterpret_cast<StreamErrorManager*>(info->err);
+        info->err->format_message(info, errorManager.message.data());
+        std::longjmp(errorManager.jumpBuffer, 1);
+    };
+
+    if(setjmp(errorManager.jumpBuffer))
+    {
+        jpeg_destroy_decompress(&decompress);
+        setError(TextureImportError::InvalidDataInImage, errorManager.message.data());
+        return true;
     }
 
-    TJPF jpegFormat;
+    jpeg_create_decompress(&decompress);
+    decompress.src = &sourceManager.pub;
 
-    switch(gpuFormat)
+    jpeg_read_header(&decompress, TRUE);
+
+    // libjpeg can't convert cmyk to rgb, those go through turbojpeg instead
+    if(decompress.jpeg_color_space == JCS_CMYK || decompress.jpeg_color_space == JCS_YCCK)
     {
-    case gpufmt::Format::R8G8B8_SRGB: [[fallthrough]];
-    case gpufmt::Format::R8G8B8_UNORM: jpegFormat = TJPF_RGB; break;
-    case gpufmt::Format::B8G8R8_SRGB: [[fallthrough]];
-    case gpufmt::Format::B8G8R8_UNORM: jpegFormat = TJPF_BGR; break;
-    case gpufmt::Format::R8G8B8A8_SRGB: [[fallthrough]];
-    case gpufmt::Format::R8G8B8A8_UNORM: jpegFormat = TJPF_RGBA; break;
-    case gpufmt::Format::B8G8R8X8_SRGB: [[fallthrough]];
-    case gpufmt::Format::B8G8R8X8_UNORM: jpegFormat = TJPF_BGRX; break;
-    case gpufmt::Format::B8G8R8A8_SRGB: [[fallthrough]];
-    case gpufmt::Format::B8G8R8A8_UNORM: jpegFormat = TJPF_BGRA; break;
-    case gpufmt::Format::A8B8G8R8_SRGB_PACK32: [[fallthrough]];
-    case gpufmt::Format::A8B8G8R8_UNORM_PACK32: jpegFormat = TJPF_ABGR; break;
-    default: jpegFormat = TJPF_RGBA;
+        jpeg_destroy_decompress(&decompress);
+        return false;
+    }
+
+    const int width = static_cast<int>(decompress.image_width);
+    const int height = static_cast<int>(decompress.image_height);
+
+    const gpufmt::Format gpuFormat =
+        selectFormat(textureAllocator, options, decompress.jpeg_color_space == JCS_GRAYSCALE);
+
+    if(gpuFormat == gpufmt::Format::UNDEFINED)
+    {
+        jpeg_destroy_decompress(&decompress);
+        return true;
     }
 
+    if(options.thumbnailSize > 0)
+    {
+        options.reduceLevels =
+            std::max(options.reduceLevels, calculateThumbnailDctLevel(width, height, options.thumbnailSize));
+    }
+
+    const cputex::Extent fullExtent{width, height, 1};
+    const int reduceLevels =
+        std::clamp(options.reduceLevels, 0, std::min(kMaxDctScaledLevel, calculateMipCount(width, height) - 1));
+    const cputex::Extent baseExtent = cputex::calculateMipExtent(fullExtent, reduceLevels);
+
     cputex::TextureParams params{
         .format = gpuFormat,
         .dimension = cputex::TextureDimension::Texture2D,
-        .extent = {width, height, 1},
+        .extent = baseExtent,
         .arraySize = 1,
         .faces = 1,
-        .mips = 1
+        .mips = (options.generateMips) ? (cputex::CountType)calculateMipCount(baseExtent.x, baseExtent.y) : 1
     };
 
     textureAllocator.preAllocation(1);
     if(!textureAllocator.allocateTexture(params, 0))
     {
+        jpeg_destroy_decompress(&decompress);
         setTextureAllocationError(params);
+        return true;
+    }
+
+    textureAllocator.postAllocation();
+
+    decompress.out_color_space = toColorSpace(toPixelFormat(gpuFormat));
+    decompress.scale_num = 1;
+    decompress.scale_denom = 1u << reduceLevels;
+
+    jpeg_start_decompress(&decompress);
+
+    const size_t pixelByteSize = gpufmt::formatInfo(gpuFormat).blockByteSize;
+    const size_t rowPitch = baseExtent.x * pixelByteSize;
+    std::span<std::byte> baseData = textureAllocator.accessTextureData(0, {});
+
+    // the scaled output rounds up while mip extents round down, the extra row and column are dropped
+    const bool exactWidth = static_cast<int>(decompress.output_width) == baseExtent.x;
+    rowBuffer.resize(decompress.output_width * pixelByteSize);
+
+    while(decompress.output_scanline < decompress.output_height)
+    {
+        const int row = static_cast<int>(decompress.output_scanline);
+        const bool directRow = exactWidth && row < baseExtent.y;
+
+        JSAMPROW rowPointer =
+            reinterpret_cast<JSAMPROW>((directRow) ? baseData.data() + row * rowPitch : rowBuffer.data());
+        jpeg_read_scanlines(&decompress, &rowPointer, 1);
+
+        if(!directRow && row < baseExtent.y)
+        {
+            std::memcpy(baseData.data() + row * rowPitch, rowBuffer.data(), rowPitch);
+        }
+    }
+
+    jpeg_finish_decompress(&decompress);
+    jpeg_destroy_decompress(&decompress);
+
+    for(cputex::CountType mip = 1; mip < params.mips; ++mip)
+    {
+        std::span<const std::byte> previousMipData =
+            textureAllocator.accessTextureData(0, MipSurfaceKey{.arraySlice = 0, .face = 0, .mip = (int8_t)(mip - 1)});
+        std::span<std::byte> mipData =
+            textureAllocator.accessTextureData(0, MipSurfaceKey{.arraySlice = 0, .face = 0, .mip = (int8_t)mip});
+
+        downsampleMip(previousMipData, cputex::calculateMipExtent(baseExtent, mip - 1), mipData,
+                      cputex::calculateMipExtent(baseExtent, mip), pixelByteSize);
+    }
+
+    return true;
+}
+
+void JpegLibJpegTurboImporter::loadYuvPlanes(void* handle, std::span<const uint8_t> imageData, int width, int height,
+                                             int subsamp, ITextureAllocator& textureAllocator)
+{
+    constexpr std::array<FormatLayout, 0> additionalFormatLayouts;
+
+    const FormatLayout selectedFormatLayout = textureAllocator.selectFormatLayout(FormatLayout::_8, additionalFormatLayouts);
+
+    if(!isValidFormatLayout(FormatLayout::_8, std::span(additionalFormatLayouts), selectedFormatLayout))
+    {
+        setTextureAllocatorFormatLayoutError(selectedFormatLayout);
         return;
     }
 
+    constexpr std::array availableFormats = {gpufmt::Format::R8_UNORM};
+
+    const gpufmt::Format planeFormat = textureAllocator.selectFormat(selectedFormatLayout, availableFormats);
+
+    if(!contains(availableFormats, planeFormat))
+    {
+        setTextureAllocatorFormatError(planeFormat);
+        return;
+    }
+
+    const int planeCount = (subsamp == TJSAMP_GRAY) ? 1 : 3;
+
+    textureAllocator.preAllocation(planeCount);
+
+    // the chroma planes are exactly ceil(size / subsampling), only the Y plane is padded to the MCU size by the decoder
+    for(int plane = 0; plane < planeCount; ++plane)
+    {
+        const bool isLuma = plane == 0;
+
+        cputex::TextureParams params{
+            .format = planeFormat,
+            .dimension = cputex::TextureDimension::Texture2D,
+            .extent = {isLuma ? width : tjPlaneWidth(plane, width, subsamp),
+                       isLuma ? height : tjPlaneHeight(plane, height, subsamp), 1},
+            .arraySize = 1,
+            .faces = 1,
+            .mips = 1
+        };
+
+        if(!textureAllocator.allocateTexture(params, plane))
+        {
+            setTextureAllocationError(params);
+            return;
+        }
+    }
+
     textureAllocator.postAllocation();
 
-    std::span<std::byte> textureData =
-        textureAllocator.accessTextureData(0, MipSurfaceKey{.arraySlice = 0, .face = 0, .mip = 0});
+    std::array<unsigned char*, 3> planes = {nullptr, nullptr, nullptr};
+
+    for(int plane = 0; plane < planeCount; ++plane)
+    {
+        planes[plane] = castWritableBytes<unsigned char>(textureAllocator.accessTextureData(plane, {})).data();
+    }
+
+    // a padded Y plane is decoded into a scratch buffer and cropped to the image size afterwards
+    const int lumaPlaneWidth = tjPlaneWidth(0, width, subsamp);
+    const int lumaPlaneHeight = tjPlaneHeight(0, height, subsamp);
+    const bool isLumaPadded = lumaPlaneWidth != width || lumaPlaneHeight != height;
+
+    unsigned char* lumaTexture = planes[0];
+    std::vector<unsigned char> paddedLuma;
 
-    result = tjDecompress2(handle, imageData.data(), jpegSize, castWritableBytes<unsigned char>(textureData).data(),
-                           width, (int)gpufmt::formatInfo(gpuFormat).blockByteSize * width, height, jpegFormat, 0);
+    if(isLumaPadded)
+    {
+        paddedLuma.resize((size_t)lumaPlaneWidth * lumaPlaneHeight);
+        planes[0] = paddedLuma.data();
+    }
+
+    // null strides make every plane tightly packed at its own width
+    const int result = tjDecompressToYUVPlanes(handle, imageData.data(), (unsigned long)imageData.size(), planes.data(),
+                                               width, nullptr, height, 0);
     if(result != 0)
     {
         setError(TextureImportError::Unknown, tjGetErrorStr());
         return;
     }
+
+    if(isLumaPadded)
+    {
+        for(int y = 0; y < height; ++y)
+        {
+            std::memcpy(lumaTexture + (size_t)y * width, paddedLuma.data() + (size_t)y * lumaPlaneWidth, width);
+        }
+    }
 }
 } // namespace teximp::jpeg
 
@@ -17,6 +17,10 @@
 #pragma warning(pop)
 #endif
 
+#include <cputex/utility.h>
+
+#include "utilities.h"
+
 namespace teximp::ktx
 {
 std::span<const char> KtxTexImpImporter::fileIdentifier() const
@@ -59,7 +63,7 @@ bool KtxTexImpImporter::checkSignature(std::istream& stream)
 }
 
 void KtxTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAllocator,
-                             TextureImportOptions /*options*/)
+                             TextureImportOptions options)
 {
     stream.read(reinterpret_cast<char*>(&mHeader), sizeof(ktx::header10));
 
@@ -111,16 +115,26 @@ void KtxTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAll
         return;
     }
 
-    const uint32_t BlockSize = gpufmt::formatInfo(format.value()).blockByteSize;
+    const gpufmt::FormatInfo& formatInfo = gpufmt::formatInfo(format.value());
+    const uint32_t BlockSize = formatInfo.blockByteSize;
+
+    const cputex::Extent fullExtent{mHeader.PixelWidth, std::max<uint32_t>(mHeader.PixelHeight, 1u),
+                                    std::max<uint32_t>(mHeader.PixelDepth, 1u)};
+    const uint32_t fileMips = std::max<uint32_t>(mHeader.NumberOfMipmapLevels, 1u);
+
+    // thumbnails start at the smallest stored mip that still covers them, the larger mips are skipped
+    const uint32_t firstMip = static_cast<uint32_t>(calculateThumbnailLevel(static_cast<int>(fullExtent.x),
+                                                                            static_cast<int>(fullExtent.y),
+                                                                            options.thumbnailSize,
+                                                                            static_cast<int>(fileMips)));
 
     cputex::TextureParams textureParams{
         .format = format.value(),
         .dimension = ktx::getTextureDimension(mHeader),
-        .extent = {mHeader.PixelWidth, std::max<uint32_t>(mHeader.PixelHeight, 1u),
-                   std::max<uint32_t>(mHeader.PixelDepth, 1u)},
+        .extent = cputex::calculateMipExtent(fullExtent, firstMip),
         .arraySize = std::max((cputex::CountType)mHeader.NumberOfArrayElements, cputex::CountType(1)),
         .faces = std::max((cputex::CountType)mHeader.NumberOfFaces, cputex::CountType(1)),
-        .mips = std::max((cputex::CountType)mHeader.NumberOfMipmapLevels, cputex::CountType(1))
+        .mips = static_cast<cputex::CountType>(fileMips - firstMip)
     };
 
     textureAllocator.preAllocation(1);
@@ -133,7 +147,7 @@ void KtxTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAll
 
     textureAllocator.postAllocation();
 
-    for(uint32_t mip = 0, mips = textureParams.mips; mip < mips; ++mip)
+    for(uint32_t mip = 0; mip < fileMips; ++mip)
     {
         uint32_t imageSize;
         stream.read(reinterpret_cast<char*>(&imageSize), sizeof(uint32_t));
@@ -150,11 +164,27 @@ void KtxTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAll
         {
             for(uint32_t face = 0, faces = textureParams.faces; face < faces; ++face)
             {
-                std::span<std::byte> surfaceSpan = textureAllocator.accessTextureData(
-                    0, MipSurfaceKey{.arraySlice = (int16_t)arraySlice, .face = (int8_t)face, .mip = (int8_t)mip});
+                size_t surfaceByteSize = 0;
+
+                if(mip < firstMip)
+                {
+                    const cputex::Extent mipExtent = cputex::calculateMipExtent(fullExtent, mip);
+                    surfaceByteSize = size_t((mipExtent.x + formatInfo.blockExtent.x - 1) / formatInfo.blockExtent.x) *
+                                      ((mipExtent.y + formatInfo.blockExtent.y - 1) / formatInfo.blockExtent.y) *
+                                      mipExtent.z * BlockSize;
 
-                stream.read(reinterpret_cast<char*>(surfaceSpan.data()),
-                            std::min(imageSize, static_cast<uint32_t>(surfaceSpan.size_bytes())));
+                    stream.seekg(std::min(static_cast<size_t>(imageSize), surfaceByteSize), std::ios_base::cur);
+                }
+                else
+                {
+                    const MipSurfaceKey surfaceKey{
+                        .arraySlice = (int16_t)arraySlice, .face = (int8_t)face, .mip = (int8_t)(mip - firstMip)};
+                    std::span<std::byte> surfaceSpan = textureAllocator.accessTextureData(0, surfaceKey);
+                    surfaceByteSize = surfaceSpan.size_bytes();
+
+                    stream.read(reinterpret_cast<char*>(surfaceSpan.data()),
+                                std::min(imageSize, static_cast<uint32_t>(surfaceByteSize)));
+                }
 
                 if(stream.fail())
                 {
@@ -165,8 +195,8 @@ void KtxTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAll
                 }
 
                 size_t offset = std::max(static_cast<size_t>(BlockSize),
-                                         glm::ceilMultiple(surfaceSpan.size_bytes(), static_cast<size_t>(4))) -
-                                surfaceSpan.size_bytes();
+                                         glm::ceilMultiple(surfaceByteSize, static_cast<size_t>(4))) -
+                                surfaceByteSize;
                 stream.seekg(offset, std::ios_base::cur);
             }
         }
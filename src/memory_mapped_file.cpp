@@ -0,0 +1,135 @@
+#include "memory_mapped_file.h"
+
+#ifdef TEXIMP_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace teximp
+{
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept
+    : mData(std::exchange(other.mData, {}))
+#ifdef TEXIMP_PLATFORM_WINDOWS
+    , mFileHandle(std::exchange(other.mFileHandle, nullptr))
+    , mMappingHandle(std::exchange(other.mMappingHandle, nullptr))
+#endif
+{}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    close();
+}
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& other) noexcept
+{
+    if(this != &other)
+    {
+        close();
+
+        mData = std::exchange(other.mData, {});
+#ifdef TEXIMP_PLATFORM_WINDOWS
+        mFileHandle = std::exchange(other.mFileHandle, nullptr);
+        mMappingHandle = std::exchange(other.mMappingHandle, nullptr);
+#endif
+    }
+
+    return *this;
+}
+
+#ifdef TEXIMP_PLATFORM_WINDOWS
+bool MemoryMappedFile::open(const std::filesystem::path& filePath)
+{
+    close();
+
+    HANDLE file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if(file == INVALID_HANDLE_VALUE) { return false; }
+
+    LARGE_INTEGER fileSize;
+
+    // empty files can't be mapped
+    if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if(mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if(view == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    mFileHandle = file;
+    mMappingHandle = mapping;
+    mData = {static_cast<const std::byte*>(view), static_cast<size_t>(fileSize.QuadPart)};
+    return true;
+}
+
+void MemoryMappedFile::close() noexcept
+{
+    if(mData.data() != nullptr) { UnmapViewOfFile(mData.data()); }
+    if(mMappingHandle != nullptr) { CloseHandle(mMappingHandle); }
+    if(mFileHandle != nullptr) { CloseHandle(mFileHandle); }
+
+    mData = {};
+    mMappingHandle = nullptr;
+    mFileHandle = nullptr;
+}
+#else
+bool MemoryMappedFile::open(const std::filesystem::path& filePath)
+{
+    close();
+
+    const int file = ::open(filePath.c_str(), O_RDONLY);
+
+    if(file == -1) { return false; }
+
+    struct stat fileStatus;
+
+    // empty files can't be mapped
+    if(fstat(file, &fileStatus) != 0 || fileStatus.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+    // the mapping keeps the file alive
+    ::close(file);
+
+    if(view == MAP_FAILED) { return false; }
+
+    mData = {static_cast<const std::byte*>(view), static_cast<size_t>(fileStatus.st_size)};
+    return true;
+}
+
+void MemoryMappedFile::close() noexcept
+{
+    if(mData.data() != nullptr) { munmap(const_cast<std::byte*>(mData.data()), mData.size()); }
+
+    mData = {};
+}
+#endif
+} // namespace teximp
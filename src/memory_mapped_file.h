@@ -0,0 +1,37 @@
+#pragma once
+
+#include <teximp/config.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace teximp
+{
+// Read only mapping of a whole file.
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile() = default;
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile(MemoryMappedFile&& other) noexcept;
+    ~MemoryMappedFile();
+
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept;
+
+    [[nodiscard]] bool open(const std::filesystem::path& filePath);
+    void close() noexcept;
+
+    [[nodiscard]] bool isOpen() const noexcept { return mData.data() != nullptr; }
+    [[nodiscard]] std::span<const std::byte> data() const noexcept { return mData; }
+
+private:
+    std::span<const std::byte> mData;
+
+#ifdef TEXIMP_PLATFORM_WINDOWS
+    void* mFileHandle = nullptr;
+    void* mMappingHandle = nullptr;
+#endif
+};
+} // namespace teximp
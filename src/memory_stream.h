@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <span>
+#include <streambuf>
+
+namespace teximp
+{
+// Seekable stream buffer reading straight from memory without copying it.
+class MemoryStreamBuffer final : public std::streambuf
+{
+public:
+    explicit MemoryStreamBuffer(std::span<const std::byte> data)
+    {
+        // the get area is never written through
+        char* begin = const_cast<char*>(reinterpret_cast<const char*>(data.data()));
+        setg(begin, begin, begin + data.size());
+    }
+
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) final
+    {
+        if((which & std::ios_base::in) == 0) { return pos_type(off_type(-1)); }
+
+        off_type position = offset;
+
+        if(direction == std::ios_base::cur) { position += gptr() - eback(); }
+        else if(direction == std::ios_base::end) { position += egptr() - eback(); }
+
+        if(position < 0 || position > egptr() - eback()) { return pos_type(off_type(-1)); }
+
+        setg(eback(), eback() + position, egptr());
+        return pos_type(position);
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) final
+    {
+        return seekoff(off_type(position), std::ios_base::beg, which);
+    }
+};
+
+class MemoryStream final : public std::istream
+{
+public:
+    explicit MemoryStream(std::span<const std::byte> data)
+        : std::istream(nullptr)
+        , mBuffer(data)
+    {
+        rdbuf(&mBuffer);
+    }
+
+private:
+    MemoryStreamBuffer mBuffer;
+};
+} // namespace teximp
@@ -0,0 +1,159 @@
+#include <teximp/png/png_importer.h>
+
+#ifdef TEXIMP_ENABLE_PNG
+
+namespace teximp::png
+{
+// color type bit from the png specification, shared by libpng and libspng
+constexpr int kColorTypeAlphaBit = 4;
+
+FileFormat PngImporter::fileFormat() const
+{
+    return FileFormat::Png;
+}
+
+bool PngImporter::hasAlpha(int colorType, bool hasTransparencyChunk) noexcept
+{
+    return (colorType & kColorTypeAlphaBit) != 0 || hasTransparencyChunk;
+}
+
+gpufmt::Format PngImporter::selectFormat(ITextureAllocator& textureAllocator, int bitDepth, bool alphaNeeded,
+                                         bool sRgb)
+{
+    FormatLayout nativeFormatLayout;
+    std::span<const FormatLayout> additionalFormatLayouts;
+
+    if(alphaNeeded && bitDepth <= 8)
+    {
+        nativeFormatLayout = FormatLayout::_8_8_8_8;
+        constexpr std::array additionalLayouts = {FormatLayout::_16_16_16_16};
+
+        additionalFormatLayouts = additionalLayouts;
+    }
+    else if(!alphaNeeded && bitDepth <= 8)
+    {
+        constexpr std::array additionalLayouts = {FormatLayout::_8_8_8_8, FormatLayout::_16_16_16,
+                                                  FormatLayout::_16_16_16_16};
+
+        nativeFormatLayout = FormatLayout::_8_8_8;
+        additionalFormatLayouts = additionalLayouts;
+    }
+    else if(alphaNeeded && bitDepth == 16) { nativeFormatLayout = FormatLayout::_16_16_16_16; }
+    else if(!alphaNeeded && bitDepth == 16)
+    {
+        constexpr std::array additionalLayouts = {FormatLayout::_16_16_16_16};
+
+        nativeFormatLayout = FormatLayout::_16_16_16;
+        additionalFormatLayouts = additionalLayouts;
+    }
+    else
+    {
+        setError(TextureImportError::UnknownFormat);
+        return gpufmt::Format::UNDEFINED;
+    }
+
+    const FormatLayout selectedFormatLayout =
+        textureAllocator.selectFormatLayout(nativeFormatLayout, additionalFormatLayouts);
+
+    if(!isValidFormatLayout(nativeFormatLayout, additionalFormatLayouts, selectedFormatLayout))
+    {
+        setTextureAllocatorFormatLayoutError(selectedFormatLayout);
+        return gpufmt::Format::UNDEFINED;
+    }
+
+    gpufmt::Format format = gpufmt::Format::UNDEFINED;
+
+    std::span<const gpufmt::Format> availableFormats;
+
+    if(selectedFormatLayout == FormatLayout::_8_8_8)
+    {
+        constexpr std::array sRgbFormats = {gpufmt::Format::B8G8R8A8_SRGB, gpufmt::Format::R8G8B8_SRGB};
+        constexpr std::array unormFormats = {gpufmt::Format::B8G8R8_UNORM, gpufmt::Format::R8G8B8_UNORM};
+
+        availableFormats = (sRgb) ? sRgbFormats : unormFormats;
+    }
+    else if(selectedFormatLayout == FormatLayout::_8_8_8_8 && alphaNeeded)
+    {
+        constexpr std::array sRgbFormats = {gpufmt::Format::B8G8R8A8_SRGB, gpufmt::Format::R8G8B8A8_SRGB};
+        constexpr std::array unormFormats = {gpufmt::Format::B8G8R8A8_UNORM, gpufmt::Format::R8G8B8A8_UNORM};
+
+        availableFormats = (sRgb) ? sRgbFormats : unormFormats;
+    }
+    else if(selectedFormatLayout == FormatLayout::_8_8_8_8 && !alphaNeeded)
+    {
+        constexpr std::array sRgbFormats = {gpufmt::Format::B8G8R8X8_SRGB, gpufmt::Format::B8G8R8A8_SRGB,
+                                            gpufmt::Format::R8G8B8A8_SRGB};
+        constexpr std::array unormFormats = {gpufmt::Format::B8G8R8X8_UNORM, gpufmt::Format::B8G8R8A8_UNORM,
+                                             gpufmt::Format::R8G8B8A8_UNORM};
+
+        availableFormats = (sRgb) ? sRgbFormats : unormFormats;
+    }
+    else if(selectedFormatLayout == FormatLayout::_16_16_16)
+    {
+        constexpr std::array formats = {gpufmt::Format::R16G16B16_UNORM};
+        availableFormats = formats;
+    }
+    else if(selectedFormatLayout == FormatLayout::_16_16_16_16)
+    {
+        constexpr std::array formats = {gpufmt::Format::R16G16B16A16_UNORM};
+        availableFormats = formats;
+    }
+
+    format = textureAllocator.selectFormat(selectedFormatLayout, availableFormats);
+
+    if(!contains(availableFormats, format))
+    {
+        setTextureAllocatorFormatError(format);
+        return gpufmt::Format::UNDEFINED;
+    }
+
+    return format;
+}
+
+gpufmt::Format PngImporter::selectIndexFormat(ITextureAllocator& textureAllocator)
+{
+    constexpr FormatLayout nativeFormatLayout = FormatLayout::_8;
+    constexpr std::array<FormatLayout, 0> additionalFormatLayouts;
+
+    const FormatLayout selectedFormatLayout =
+        textureAllocator.selectFormatLayout(nativeFormatLayout, additionalFormatLayouts);
+
+    if(!isValidFormatLayout(nativeFormatLayout, std::span(additionalFormatLayouts), selectedFormatLayout))
+    {
+        setTextureAllocatorFormatLayoutError(selectedFormatLayout);
+        return gpufmt::Format::UNDEFINED;
+    }
+
+    constexpr std::array availableFormats = {gpufmt::Format::R8_UINT, gpufmt::Format::R8_UNORM};
+
+    const gpufmt::Format format = textureAllocator.selectFormat(selectedFormatLayout, availableFormats);
+
+    if(!contains(availableFormats, format))
+    {
+        setTextureAllocatorFormatError(format);
+        return gpufmt::Format::UNDEFINED;
+    }
+
+    return format;
+}
+
+gpufmt::Format PngImporter::selectPaletteFormat(ITextureAllocator& textureAllocator, bool sRgb)
+{
+    constexpr std::array sRgbFormats = {gpufmt::Format::R8G8B8A8_SRGB, gpufmt::Format::B8G8R8A8_SRGB};
+    constexpr std::array unormFormats = {gpufmt::Format::R8G8B8A8_UNORM, gpufmt::Format::B8G8R8A8_UNORM};
+
+    const std::span<const gpufmt::Format> availableFormats = (sRgb) ? sRgbFormats : unormFormats;
+
+    const gpufmt::Format format = textureAllocator.selectFormat(FormatLayout::_8_8_8_8, availableFormats);
+
+    if(!contains(availableFormats, format))
+    {
+        setTextureAllocatorFormatError(format);
+        return gpufmt::Format::UNDEFINED;
+    }
+
+    return format;
+}
+} // namespace teximp::png
+
+#endif // TEXIMP_ENABLE_PNG
@@ -2,117 +2,523 @@
 
 #ifdef TEXIMP_ENABLE_PNG_BACKEND_LIBPNG
 
+#include "utilities.h"
+
 #include <gpufmt/string.h>
 #include <png.h>
 #include <teximp/string.h>
+#include <zlib.h>
 
 #include <bit>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <new>
+#include <optional>
 
 #include <gsl/gsl-lite.hpp>
 
 namespace teximp::png
 {
-gpufmt::Format PngLibPngImporter::selectFormat(ITextureAllocator& textureAllocator, int bitDepth, bool alphaNeeded,
-                                               bool sRgb)
+constexpr std::span<const gpufmt::Format> getFormatsForLayout(FormatLayout formatLayout, bool needsAlpha, bool sRGB)
+{
+    return {};
+}
+
+//---------------------------------
+// APNG
+//---------------------------------
+
+void skipPngIntegrityChecks(png_structp pngRead)
+{
+    png_set_crc_action(pngRead, PNG_CRC_QUIET_USE, PNG_CRC_QUIET_USE);
+#ifdef PNG_IGNORE_ADLER32
+    png_set_option(pngRead, PNG_IGNORE_ADLER32, PNG_OPTION_ON);
+#endif
+}
+
+constexpr std::array<uint8_t, 8> kPngSignature = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+constexpr uint8_t kApngDisposeOpNone = 0;
+constexpr uint8_t kApngDisposeOpBackground = 1;
+constexpr uint8_t kApngDisposeOpPrevious = 2;
+
+constexpr uint8_t kApngBlendOpSource = 0;
+constexpr uint8_t kApngBlendOpOver = 1;
+
+struct ApngFrameControl
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t xOffset = 0;
+    uint32_t yOffset = 0;
+    uint16_t delayNumerator = 0;
+    uint16_t delayDenominator = 0;
+    uint8_t disposeOp = kApngDisposeOpNone;
+    uint8_t blendOp = kApngBlendOpSource;
+};
+
+struct ApngFrame
+{
+    ApngFrameControl control;
+    std::vector<std::span<const std::byte>> dataChunks;
+};
+
+struct ApngChunks
+{
+    // IHDR chunk data
+    std::span<const std::byte> header;
+    // complete chunks (length, type, data and crc) that precede the image data and are needed to decode each frame
+    std::vector<std::span<const std::byte>> ancillaryChunks;
+    std::vector<ApngFrame> frames;
+    uint32_t playCount = 0;
+    bool hasSrgbChunk = false;
+};
+
+struct ApngFrameDecodeError
+{};
+
+[[nodiscard]] uint32_t readUInt32BigEndian(std::span<const std::byte> bytes)
+{
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+[[nodiscard]] uint16_t readUInt16BigEndian(std::span<const std::byte> bytes)
+{
+    return static_cast<uint16_t>((static_cast<uint32_t>(bytes[0]) << 8) | static_cast<uint32_t>(bytes[1]));
+}
+
+void writeUInt32BigEndian(std::vector<std::byte>& bytes, uint32_t value)
+{
+    bytes.push_back(static_cast<std::byte>(value >> 24));
+    bytes.push_back(static_cast<std::byte>(value >> 16));
+    bytes.push_back(static_cast<std::byte>(value >> 8));
+    bytes.push_back(static_cast<std::byte>(value));
+}
+
+[[nodiscard]] bool isChunkType(std::span<const std::byte> type, const char (&name)[5])
+{
+    return std::memcmp(type.data(), name, 4) == 0;
+}
+
+// Walks the chunk headers up to the first IDAT chunk without reading any image data. The stream is left where it was.
+[[nodiscard]] bool hasAnimationControlChunk(std::istream& stream)
 {
-    FormatLayout nativeFormatLayout;
-    std::span<const FormatLayout> additionalFormatLayouts;
+    const std::streampos startPos = stream.tellg();
+    bool found = false;
 
-    if(alphaNeeded && bitDepth <= 8)
+    while(true)
     {
-        nativeFormatLayout = FormatLayout::_8_8_8_8;
-        constexpr std::array additionalLayouts = {FormatLayout::_16_16_16_16};
+        std::array<std::byte, 8> chunkHeader;
+        stream.read(reinterpret_cast<char*>(chunkHeader.data()), chunkHeader.size());
+
+        if(stream.fail()) { break; }
+
+        const std::span<const std::byte> type = std::span(chunkHeader).subspan(4, 4);
+
+        if(isChunkType(type, "acTL"))
+        {
+            found = true;
+            break;
+        }
+
+        if(isChunkType(type, "IDAT") || isChunkType(type, "IEND")) { break; }
+
+        stream.seekg(static_cast<std::streamoff>(readUInt32BigEndian(chunkHeader)) + 4, std::ios_base::cur);
+    }
+
+    stream.clear();
+    stream.seekg(startPos);
+
+    return found;
+}
+
+[[nodiscard]] bool parseApngChunks(std::span<const std::byte> data, bool verifyCrc, ApngChunks& chunks,
+                                   std::string& errorMessage)
+{
+    std::optional<size_t> defaultImageFrameIndex;
+    bool imageDataFound = false;
+    size_t offset = 0;
+
+    while(offset + 12 <= data.size())
+    {
+        const uint32_t length = readUInt32BigEndian(data.subspan(offset));
+
+        if(length > data.size() - offset - 12)
+        {
+            errorMessage = "Chunk extends past the end of the file.";
+            return false;
+        }
+
+        const std::span<const std::byte> chunk = data.subspan(offset, length + 12);
+        const std::span<const std::byte> type = chunk.subspan(4, 4);
+        const std::span<const std::byte> chunkData = chunk.subspan(8, length);
+        offset += chunk.size();
+
+        if(verifyCrc)
+        {
+            const uLong crc =
+                crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(type.data()), static_cast<uInt>(length + 4));
+
+            if(crc != readUInt32BigEndian(chunk.subspan(8 + length)))
+            {
+                errorMessage = std::format("CRC error in {} chunk.",
+                                           std::string_view(reinterpret_cast<const char*>(type.data()), 4));
+                return false;
+            }
+        }
+
+        if(isChunkType(type, "IHDR"))
+        {
+            if(length != 13)
+            {
+                errorMessage = "Invalid IHDR chunk.";
+                return false;
+            }
+
+            chunks.header = chunkData;
+        }
+        else if(isChunkType(type, "acTL"))
+        {
+            if(length != 8)
+            {
+                errorMessage = "Invalid acTL chunk.";
+                return false;
+            }
+
+            chunks.playCount = readUInt32BigEndian(chunkData.subspan(4));
+        }
+        else if(isChunkType(type, "fcTL"))
+        {
+            if(length != 26)
+            {
+                errorMessage = "Invalid fcTL chunk.";
+                return false;
+            }
+
+            ApngFrame& frame = chunks.frames.emplace_back();
+            frame.control.width = readUInt32BigEndian(chunkData.subspan(4));
+            frame.control.height = readUInt32BigEndian(chunkData.subspan(8));
+            frame.control.xOffset = readUInt32BigEndian(chunkData.subspan(12));
+            frame.control.yOffset = readUInt32BigEndian(chunkData.subspan(16));
+            frame.control.delayNumerator = readUInt16BigEndian(chunkData.subspan(20));
+            frame.control.delayDenominator = readUInt16BigEndian(chunkData.subspan(22));
+            frame.control.disposeOp = static_cast<uint8_t>(chunkData[24]);
+            frame.control.blendOp = static_cast<uint8_t>(chunkData[25]);
+        }
+        else if(isChunkType(type, "IDAT"))
+        {
+            if(!imageDataFound && !chunks.frames.empty()) { defaultImageFrameIndex = 0; }
+
+            imageDataFound = true;
+
+            // the default image is only part of the animation when its fcTL comes before the first IDAT
+            if(defaultImageFrameIndex) { chunks.frames[*defaultImageFrameIndex].dataChunks.push_back(chunkData); }
+        }
+        else if(isChunkType(type, "fdAT"))
+        {
+            if(length < 4 || chunks.frames.empty())
+            {
+                errorMessage = "Invalid fdAT chunk.";
+                return false;
+            }
 
-        additionalFormatLayouts = additionalLayouts;
+            chunks.frames.back().dataChunks.push_back(chunkData.subspan(4));
+        }
+        else if(isChunkType(type, "IEND")) { break; }
+        else if(!imageDataFound)
+        {
+            if(isChunkType(type, "sRGB")) { chunks.hasSrgbChunk = true; }
+
+            chunks.ancillaryChunks.push_back(chunk);
+        }
     }
-    else if(!alphaNeeded && bitDepth <= 8)
+
+    if(chunks.header.empty())
     {
-        constexpr std::array additionalLayouts = {FormatLayout::_8_8_8_8, FormatLayout::_16_16_16,
-                                                  FormatLayout::_16_16_16_16};
+        errorMessage = "Missing IHDR chunk.";
+        return false;
+    }
 
-        nativeFormatLayout = FormatLayout::_8_8_8;
-        additionalFormatLayouts = additionalLayouts;
+    if(chunks.frames.empty())
+    {
+        errorMessage = "Animated png has no frames.";
+        return false;
     }
-    else if(alphaNeeded && bitDepth == 16) { nativeFormatLayout = FormatLayout::_16_16_16_16; }
-    else if(!alphaNeeded && bitDepth == 16)
+
+    return true;
+}
+
+// Builds a standalone png for a single frame so frames can be decoded independently of each other. Crcs of the
+// rewritten chunks are left as zero, the decoder is told to ignore them.
+[[nodiscard]] std::vector<std::byte> buildApngFramePng(const ApngChunks& chunks, const ApngFrame& frame)
+{
+    auto appendChunk = [](std::vector<std::byte>& bytes, const char(&type)[5], std::span<const std::byte> chunkData)
     {
-        constexpr std::array additionalLayouts = {FormatLayout::_16_16_16_16};
+        writeUInt32BigEndian(bytes, static_cast<uint32_t>(chunkData.size()));
+        bytes.insert(bytes.end(), reinterpret_cast<const std::byte*>(type), reinterpret_cast<const std::byte*>(type) + 4);
+        bytes.insert(bytes.end(), chunkData.begin(), chunkData.end());
+        writeUInt32BigEndian(bytes, 0u);
+    };
 
-        nativeFormatLayout = FormatLayout::_16_16_16;
-        additionalFormatLayouts = additionalLayouts;
+    size_t byteSize = kPngSignature.size() + 25 + 12;
+
+    for(std::span<const std::byte> chunk : chunks.ancillaryChunks)
+    {
+        byteSize += chunk.size();
     }
-    else
+
+    for(std::span<const std::byte> dataChunk : frame.dataChunks)
     {
-        setError(TextureImportError::UnknownFormat);
-        return gpufmt::Format::UNDEFINED;
+        byteSize += dataChunk.size() + 12;
     }
 
-    const FormatLayout selectedFormatLayout =
-        textureAllocator.selectFormatLayout(nativeFormatLayout, additionalFormatLayouts);
+    std::vector<std::byte> bytes;
+    bytes.reserve(byteSize);
+
+    const auto signatureBytes = std::as_bytes(std::span(kPngSignature));
+    bytes.insert(bytes.end(), signatureBytes.begin(), signatureBytes.end());
 
-    if(!isValidFormatLayout(nativeFormatLayout, additionalFormatLayouts, selectedFormatLayout))
+    std::array<std::byte, 13> header;
+    std::copy(chunks.header.begin(), chunks.header.end(), header.begin());
+
+    for(int i = 0; i < 4; ++i)
     {
-        setTextureAllocatorFormatLayoutError(selectedFormatLayout);
-        return gpufmt::Format::UNDEFINED;
+        header[i] = static_cast<std::byte>(frame.control.width >> (24 - i * 8));
+        header[4 + i] = static_cast<std::byte>(frame.control.height >> (24 - i * 8));
     }
 
-    gpufmt::Format format = gpufmt::Format::UNDEFINED;
-
-    std::span<const gpufmt::Format> availableFormats;
+    appendChunk(bytes, "IHDR", header);
 
-    if(selectedFormatLayout == FormatLayout::_8_8_8)
+    for(std::span<const std::byte> chunk : chunks.ancillaryChunks)
     {
-        constexpr std::array sRgbFormats = {gpufmt::Format::B8G8R8A8_SRGB, gpufmt::Format::R8G8B8_SRGB};
-        constexpr std::array unormFormats = {gpufmt::Format::B8G8R8_UNORM, gpufmt::Format::R8G8B8_UNORM};
+        bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+    }
 
-        availableFormats = (sRgb) ? sRgbFormats : unormFormats;
+    for(std::span<const std::byte> dataChunk : frame.dataChunks)
+    {
+        appendChunk(bytes, "IDAT", dataChunk);
     }
-    else if(selectedFormatLayout == FormatLayout::_8_8_8_8 && alphaNeeded)
+
+    appendChunk(bytes, "IEND", {});
+
+    return bytes;
+}
+
+// Decodes a frame to 8 or 16 bit RGBA (or BGRA). Only touches its own arguments so it can run on any thread.
+[[nodiscard]] bool decodeApngFrame(std::span<const std::byte> framePng, std::span<std::byte> output, size_t rowPitch,
+                                   bool bgr, bool output16, bool trustedSource, std::string& errorMessage)
+{
+    struct MemoryReader
     {
-        constexpr std::array sRgbFormats = {gpufmt::Format::B8G8R8A8_SRGB, gpufmt::Format::R8G8B8A8_SRGB};
-        constexpr std::array unormFormats = {gpufmt::Format::B8G8R8A8_UNORM, gpufmt::Format::R8G8B8A8_UNORM};
+        std::span<const std::byte> data;
+        size_t offset = 0;
+    };
 
-        availableFormats = (sRgb) ? sRgbFormats : unormFormats;
-    }
-    else if(selectedFormatLayout == FormatLayout::_8_8_8_8 && !alphaNeeded)
+    png_structp pngRead = nullptr;
+    png_infop pngInfo = nullptr;
+
+    auto scopeCleanup = gsl::finally([&pngRead, &pngInfo]() { png_destroy_read_struct(&pngRead, &pngInfo, nullptr); });
+
+    try
     {
-        constexpr std::array sRgbFormats = {gpufmt::Format::B8G8R8X8_SRGB, gpufmt::Format::B8G8R8A8_SRGB,
-                                            gpufmt::Format::R8G8B8A8_SRGB};
-        constexpr std::array unormFormats = {gpufmt::Format::B8G8R8X8_UNORM, gpufmt::Format::B8G8R8A8_UNORM,
-                                             gpufmt::Format::R8G8B8A8_UNORM};
+        pngRead = png_create_read_struct(
+            PNG_LIBPNG_VER_STRING, &errorMessage,
+            [](png_structp pngPtr, png_const_charp message)
+            {
+                *static_cast<std::string*>(png_get_error_ptr(pngPtr)) = message;
+                throw ApngFrameDecodeError();
+            },
+            [](png_structp /*pngPtr*/, png_const_charp /*message*/) { /*ignore warnings*/ });
 
-        availableFormats = (sRgb) ? sRgbFormats : unormFormats;
+        if(pngRead == nullptr) { return false; }
+
+        pngInfo = png_create_info_struct(pngRead);
+
+        if(pngInfo == nullptr) { return false; }
+
+        MemoryReader reader{framePng};
+
+        png_set_read_fn(pngRead, &reader,
+                        [](png_structp pngRead, png_bytep data, png_size_t length)
+                        {
+                            MemoryReader& reader = *static_cast<MemoryReader*>(png_get_io_ptr(pngRead));
+
+                            if(length > reader.data.size() - reader.offset) { png_error(pngRead, "Unexpected end of frame data."); }
+
+                            std::memcpy(data, reader.data.data() + reader.offset, length);
+                            reader.offset += length;
+                        });
+
+        // chunk crcs were verified (or deliberately skipped) when the animation was parsed
+        if(trustedSource) { skipPngIntegrityChecks(pngRead); }
+        else { png_set_crc_action(pngRead, PNG_CRC_QUIET_USE, PNG_CRC_QUIET_USE); }
+
+        png_set_user_limits(pngRead, kMaxTextureWidth, kMaxTextureHeight);
+        png_read_info(pngRead, pngInfo);
+
+        const int bitDepth = png_get_bit_depth(pngRead, pngInfo);
+        const int colorType = png_get_color_type(pngRead, pngInfo);
+        const bool hasAlpha =
+            (colorType & PNG_COLOR_MASK_ALPHA) != 0 || png_get_valid(pngRead, pngInfo, PNG_INFO_tRNS) != 0;
+
+        // palette to rgb, 1, 2 and 4 bit gray to 8 bit, tRNS to alpha
+        png_set_expand(pngRead);
+
+        if((colorType & PNG_COLOR_MASK_COLOR) == 0) { png_set_gray_to_rgb(pngRead); }
+
+        if(!hasAlpha) { png_set_add_alpha(pngRead, 0xFFFF, PNG_FILLER_AFTER); }
+
+        if(output16)
+        {
+            if(bitDepth < 16) { png_set_expand_16(pngRead); }
+            if(std::endian::native == std::endian::little) { png_set_swap(pngRead); }
+        }
+        else if(bitDepth == 16) { png_set_strip_16(pngRead); }
+
+        if(bgr) { png_set_bgr(pngRead); }
+
+        png_set_interlace_handling(pngRead);
+
+        png_read_update_info(pngRead, pngInfo);
+
+        const uint32_t height = png_get_image_height(pngRead, pngInfo);
+
+        std::vector<png_byte*> rows(height);
+        for(size_t row = 0; row < height; ++row)
+        {
+            rows[row] = castWritableBytes<png_byte>(output.subspan(row * rowPitch)).data();
+        }
+
+        png_read_image(pngRead, rows.data());
     }
-    else if(selectedFormatLayout == FormatLayout::_16_16_16)
+    catch(const ApngFrameDecodeError&)
     {
-        constexpr std::array formats = {gpufmt::Format::R16G16B16_UNORM};
-        availableFormats = formats;
+        return false;
     }
-    else if(selectedFormatLayout == FormatLayout::_16_16_16_16)
+
+    return true;
+}
+
+template<class T>
+void blendApngFrameOver(std::span<const std::byte> frameBytes, std::span<std::byte> canvasBytes, uint32_t canvasWidth,
+                        const ApngFrameControl& control)
+{
+    constexpr float maxValue = static_cast<float>(std::numeric_limits<T>::max());
+    constexpr float invMaxValue = 1.0f / maxValue;
+
+    std::span<const T> frame = castBytes<T>(frameBytes);
+    std::span<T> canvas = castWritableBytes<T>(canvasBytes);
+
+    for(uint32_t y = 0; y < control.height; ++y)
     {
-        constexpr std::array formats = {gpufmt::Format::R16G16B16A16_UNORM};
-        availableFormats = formats;
+        for(uint32_t x = 0; x < control.width; ++x)
+        {
+            const T* src = frame.data() + (y * control.width + x) * 4;
+            T* dst = canvas.data() + ((y + control.yOffset) * canvasWidth + x + control.xOffset) * 4;
+
+            if(src[3] == std::numeric_limits<T>::max())
+            {
+                std::copy_n(src, 4, dst);
+                continue;
+            }
+
+            if(src[3] == 0) { continue; }
+
+            const float srcAlpha = src[3] * invMaxValue;
+            const float dstAlpha = dst[3] * invMaxValue * (1.0f - srcAlpha);
+            const float outAlpha = srcAlpha + dstAlpha;
+
+            for(int channel = 0; channel < 3; ++channel)
+            {
+                dst[channel] = static_cast<T>(std::round((src[channel] * srcAlpha + dst[channel] * dstAlpha) / outAlpha));
+            }
+
+            dst[3] = static_cast<T>(std::round(outAlpha * maxValue));
+        }
     }
+}
 
-    format = textureAllocator.selectFormat(selectedFormatLayout, availableFormats);
+void copyApngFrameRegion(std::span<const std::byte> frameBytes, std::span<std::byte> canvasBytes, uint32_t canvasWidth,
+                         const ApngFrameControl& control, size_t pixelByteSize)
+{
+    const size_t frameRowPitch = control.width * pixelByteSize;
 
-    if(!contains(availableFormats, format))
+    for(uint32_t y = 0; y < control.height; ++y)
     {
-        setTextureAllocatorFormatError(format);
-        return gpufmt::Format::UNDEFINED;
+        std::memcpy(canvasBytes.data() + ((y + control.yOffset) * canvasWidth + control.xOffset) * pixelByteSize,
+                    frameBytes.data() + y * frameRowPitch, frameRowPitch);
     }
+}
 
-    return format;
+void clearApngFrameRegion(std::span<std::byte> canvasBytes, uint32_t canvasWidth, const ApngFrameControl& control,
+                          size_t pixelByteSize)
+{
+    for(uint32_t y = 0; y < control.height; ++y)
+    {
+        std::memset(canvasBytes.data() + ((y + control.yOffset) * canvasWidth + control.xOffset) * pixelByteSize, 0,
+                    control.width * pixelByteSize);
+    }
 }
 
-constexpr std::span<const gpufmt::Format> getFormatsForLayout(FormatLayout formatLayout, bool needsAlpha, bool sRGB)
+[[nodiscard]] bool isFullCanvasApngFrame(const ApngFrameControl& control, uint32_t canvasWidth, uint32_t canvasHeight)
 {
-    return {};
+    return control.xOffset == 0 && control.yOffset == 0 && control.width == canvasWidth &&
+           control.height == canvasHeight;
 }
 
-FileFormat PngLibPngImporter::fileFormat() const
+// Frames that cover the whole canvas and replace it don't depend on the previous frames, so they are decoded straight
+// into their array slice.
+[[nodiscard]] bool canDecodeApngFrameInPlace(const ApngFrame& frame, size_t frameIndex, uint32_t canvasWidth,
+                                             uint32_t canvasHeight)
 {
-    return FileFormat::Png;
+    return isFullCanvasApngFrame(frame.control, canvasWidth, canvasHeight) &&
+           (frameIndex == 0 || frame.control.blendOp == kApngBlendOpSource);
+}
+
+template<class T>
+void compositeApngFrames(const ApngChunks& chunks, std::span<const std::span<std::byte>> slices,
+                         std::span<const std::vector<std::byte>> frameBuffers, uint32_t canvasWidth,
+                         uint32_t canvasHeight)
+{
+    constexpr size_t pixelByteSize = sizeof(T) * 4;
+
+    // canvas state before the current frame is rendered
+    std::vector<std::byte> canvas(canvasWidth * canvasHeight * pixelByteSize, std::byte(0));
+
+    for(size_t i = 0; i < chunks.frames.size(); ++i)
+    {
+        const ApngFrameControl& control = chunks.frames[i].control;
+        std::span<std::byte> slice = slices[i];
+
+        if(!canDecodeApngFrameInPlace(chunks.frames[i], i, canvasWidth, canvasHeight))
+        {
+            std::copy(canvas.begin(), canvas.end(), slice.begin());
+
+            if(control.blendOp == kApngBlendOpOver)
+            {
+                blendApngFrameOver<T>(frameBuffers[i], slice, canvasWidth, control);
+            }
+            else { copyApngFrameRegion(frameBuffers[i], slice, canvasWidth, control, pixelByteSize); }
+        }
+
+        if(i + 1 == chunks.frames.size()) { break; }
+
+        const uint8_t disposeOp =
+            (i == 0 && control.disposeOp == kApngDisposeOpPrevious) ? kApngDisposeOpBackground : control.disposeOp;
+
+        if(disposeOp == kApngDisposeOpNone)
+        {
+            std::copy_n(slice.begin(), canvas.size(), canvas.begin());
+        }
+        else if(disposeOp == kApngDisposeOpBackground)
+        {
+            std::copy_n(slice.begin(), canvas.size(), canvas.begin());
+            clearApngFrameRegion(canvas, canvasWidth, control, pixelByteSize);
+        }
+    }
 }
 
 void PngLibPngImporter::setErrorMessageFromLibPng(const char* message)
@@ -137,6 +543,8 @@ bool PngLibPngImporter::checkSignature(std::istream& stream)
 
 void PngLibPngImporter::load(std::istream& stream, ITextureAllocator& textureAllocator, TextureImportOptions options)
 {
+    if(options.importAnimationFrames && loadAnimation(stream, textureAllocator, options)) { return; }
+
     try
     {
         png_structp pngRead = nullptr;
@@ -180,6 +588,8 @@ void PngLibPngImporter::load(std::istream& stream, ITextureAllocator& textureAll
 
         png_set_sig_bytes(pngRead, 8);
 
+        if(options.trustedSource) { skipPngIntegrityChecks(pngRead); }
+
         png_set_user_limits(pngRead, 16384, 16384);
         png_read_info(pngRead, pngInfo);
 
@@ -197,11 +607,18 @@ void PngLibPngImporter::load(std::istream& stream, ITextureAllocator& textureAll
                      &filterMethod);
         channelCount = png_get_channels(pngRead, pngInfo);
 
-        pngHasAlpha = channelCount == 4 || colorType == PNG_COLOR_TYPE_GRAY_ALPHA || colorType == PNG_COLOR_TYPE_RGBA;
+        const bool hasTransparencyChunk = png_get_valid(pngRead, pngInfo, PNG_INFO_tRNS) != 0;
+        pngHasAlpha = hasAlpha(colorType, hasTransparencyChunk);
 
         int srgbIntent;
         const bool sRgb = png_get_sRGB(pngRead, pngInfo, &srgbIntent) == 0;
 
+        if(colorType == PNG_COLOR_TYPE_PALETTE && options.preservePalette)
+        {
+            readPalettizedImage(pngRead, pngInfo, textureAllocator, sRgb);
+            return;
+        }
+
         if(bitDepth == 16 && std::endian::native == std::endian::little) { png_set_swap(pngRead); }
 
         if(!pngHasAlpha && options.padRgbWithAlpha) { png_set_add_alpha(pngRead, 0xFFFFFFFF, PNG_FILLER_AFTER); }
@@ -212,11 +629,7 @@ void PngLibPngImporter::load(std::istream& stream, ITextureAllocator& textureAll
 
         if(gpuFormat == gpufmt::Format::UNDEFINED) { return; }
 
-        if(gpuFormat == gpufmt::Format::B8G8R8A8_SRGB || gpuFormat == gpufmt::Format::B8G8R8A8_UNORM ||
-           gpuFormat == gpufmt::Format::B8G8R8X8_SRGB || gpuFormat == gpufmt::Format::B8G8R8X8_UNORM)
-        {
-            png_set_bgr(pngRead);
-        }
+        if(isBgrFormat(gpuFormat)) { png_set_bgr(pngRead); }
 
         switch(colorType)
         {
@@ -231,6 +644,8 @@ void PngLibPngImporter::load(std::istream& stream, ITextureAllocator& textureAll
             break;
         }
 
+        if(hasTransparencyChunk) { png_set_tRNS_to_alpha(pngRead); }
+
         png_set_interlace_handling(pngRead);
 
         png_read_update_info(pngRead, pngInfo);
@@ -269,6 +684,271 @@ void PngLibPngImporter::load(std::istream& stream, ITextureAllocator& textureAll
     {
     }
 }
+
+bool PngLibPngImporter::loadAnimation(std::istream& stream, ITextureAllocator& textureAllocator,
+                                      TextureImportOptions options)
+{
+    if(!hasAnimationControlChunk(stream)) { return false; }
+
+    const std::streampos dataStart = stream.tellg();
+    stream.seekg(0, std::ios_base::end);
+    const std::streamoff dataSize = stream.tellg() - dataStart;
+    stream.seekg(dataStart);
+
+    std::vector<std::byte> fileData(dataSize);
+    stream.read(reinterpret_cast<char*>(fileData.data()), dataSize);
+
+    if(stream.fail())
+    {
+        setError(TextureImportError::FailedToReadFile, "Could not read the file.");
+        return true;
+    }
+
+    ApngChunks chunks;
+    std::string errorMessage;
+
+    if(!parseApngChunks(fileData, !options.trustedSource, chunks, errorMessage))
+    {
+        setError(TextureImportError::InvalidDataInImage, std::move(errorMessage));
+        return true;
+    }
+
+    const uint32_t canvasWidth = readUInt32BigEndian(chunks.header);
+    const uint32_t canvasHeight = readUInt32BigEndian(chunks.header.subspan(4));
+    const int bitDepth = static_cast<int>(chunks.header[8]);
+
+    if(canvasWidth == 0 || canvasHeight == 0)
+    {
+        setError(TextureImportError::InvalidDataInImage, "Image has a width or height of 0.");
+        return true;
+    }
+
+    if(canvasWidth > kMaxTextureWidth || canvasHeight > kMaxTextureHeight)
+    {
+        setError(TextureImportError::DimensionsTooLarge,
+                 std::format("Image has size {}x{}. Max supported dimensions are {}x{}.", canvasWidth, canvasHeight,
+                             kMaxTextureWidth, kMaxTextureHeight));
+        return true;
+    }
+
+    // frames are addressed through MipSurfaceKey::arraySlice
+    constexpr size_t maxFrameCount = static_cast<size_t>(std::numeric_limits<int16_t>::max()) + 1;
+
+    if(chunks.frames.size() > maxFrameCount)
+    {
+        setError(TextureImportError::InvalidDataInImage,
+                 std::format("Animation has {} frames. Max supported frame count is {}.", chunks.frames.size(),
+                             maxFrameCount));
+        return true;
+    }
+
+    for(size_t i = 0; i < chunks.frames.size(); ++i)
+    {
+        const ApngFrame& frame = chunks.frames[i];
+        const ApngFrameControl& control = frame.control;
+
+        // compared in 64 bits so frames larger than the canvas can't wrap around
+        if(control.width == 0 || control.height == 0 ||
+           static_cast<uint64_t>(control.xOffset) + control.width > canvasWidth ||
+           static_cast<uint64_t>(control.yOffset) + control.height > canvasHeight ||
+           control.disposeOp > kApngDisposeOpPrevious || control.blendOp > kApngBlendOpOver ||
+           frame.dataChunks.empty())
+        {
+            setError(TextureImportError::InvalidDataInImage, std::format("Invalid animation frame {}.", i));
+            return true;
+        }
+    }
+
+    const bool sRgb = !chunks.hasSrgbChunk;
+
+    const gpufmt::Format gpuFormat = selectFormat(textureAllocator, (bitDepth == 16) ? 16 : 8, true, sRgb);
+
+    if(gpuFormat == gpufmt::Format::UNDEFINED) { return true; }
+
+    const bool bgr = isBgrFormat(gpuFormat);
+    const size_t pixelByteSize = gpufmt::formatInfo(gpuFormat).blockByteSize;
+    const bool output16 = pixelByteSize == 8;
+    const int frameCount = static_cast<int>(chunks.frames.size());
+
+    cputex::TextureParams textureParams{
+        .format = gpuFormat,
+        .dimension = cputex::TextureDimension::Texture2D,
+        .extent = {canvasWidth, canvasHeight, 1},
+        .arraySize = static_cast<cputex::CountType>(frameCount),
+        .faces = 1,
+        .mips = 1
+    };
+
+    textureAllocator.preAllocation(1);
+
+    if(!textureAllocator.allocateTexture(textureParams, 0))
+    {
+        setTextureAllocationError(textureParams);
+        return true;
+    }
+
+    textureAllocator.postAllocation();
+
+    std::vector<std::span<std::byte>> slices(frameCount);
+
+    for(int i = 0; i < frameCount; ++i)
+    {
+        slices[i] = textureAllocator.accessTextureData(0, MipSurfaceKey{.arraySlice = (int16_t)i, .face = 0, .mip = 0});
+    }
+
+    mAnimationPlayCount = chunks.playCount;
+    mAnimationFrames.resize(frameCount);
+
+    for(int i = 0; i < frameCount; ++i)
+    {
+        const ApngFrameControl& control = chunks.frames[i].control;
+        mAnimationFrames[i].delayNumerator = control.delayNumerator;
+        mAnimationFrames[i].delayDenominator = (control.delayDenominator == 0) ? 100 : control.delayDenominator;
+    }
+
+    std::vector<std::vector<std::byte>> frameBuffers(frameCount);
+    std::vector<std::string> frameErrors(frameCount);
+    std::vector<uint8_t> framesDecoded(frameCount, 0);
+
+    parallelFor(frameCount, resolveThreadCount(options.threadCount),
+                [&](int i)
+                {
+                    const ApngFrame& frame = chunks.frames[i];
+                    std::span<std::byte> output;
+
+                    // parallelFor's func must not throw
+                    try
+                    {
+                        if(canDecodeApngFrameInPlace(frame, i, canvasWidth, canvasHeight)) { output = slices[i]; }
+                        else
+                        {
+                            frameBuffers[i].resize(static_cast<size_t>(frame.control.width) * frame.control.height *
+                                                   pixelByteSize);
+                            output = frameBuffers[i];
+                        }
+
+                        const std::vector<std::byte> framePng = buildApngFramePng(chunks, frame);
+
+                        framesDecoded[i] = decodeApngFrame(framePng, output, frame.control.width * pixelByteSize, bgr,
+                                                           output16, options.trustedSource, frameErrors[i]);
+                    }
+                    catch(const std::bad_alloc&)
+                    {
+                        frameErrors[i] = "Out of memory.";
+                    }
+                });
+
+    for(int i = 0; i < frameCount; ++i)
+    {
+        if(!framesDecoded[i])
+        {
+            setError(TextureImportError::InvalidDataInImage,
+                     std::format("Failed to decode animation frame {}: {}", i, frameErrors[i]));
+            return true;
+        }
+    }
+
+    if(output16) { compositeApngFrames<uint16_t>(chunks, slices, frameBuffers, canvasWidth, canvasHeight); }
+    else { compositeApngFrames<uint8_t>(chunks, slices, frameBuffers, canvasWidth, canvasHeight); }
+
+    return true;
+}
+
+void PngLibPngImporter::readPalettizedImage(png_struct_def* pngRead, png_info_def* pngInfo,
+                                            ITextureAllocator& textureAllocator, bool sRgb)
+{
+    png_colorp palette = nullptr;
+    int paletteSize = 0;
+
+    if(png_get_PLTE(pngRead, pngInfo, &palette, &paletteSize) == 0 || paletteSize <= 0)
+    {
+        setError(TextureImportError::InvalidDataInImage, "Palettized png is missing its PLTE chunk.");
+        return;
+    }
+
+    png_bytep transparency = nullptr;
+    int transparencySize = 0;
+
+    if(png_get_valid(pngRead, pngInfo, PNG_INFO_tRNS))
+    {
+        png_get_tRNS(pngRead, pngInfo, &transparency, &transparencySize, nullptr);
+    }
+
+    const gpufmt::Format indexFormat = selectIndexFormat(textureAllocator);
+
+    if(indexFormat == gpufmt::Format::UNDEFINED) { return; }
+
+    const gpufmt::Format paletteFormat = selectPaletteFormat(textureAllocator, sRgb);
+
+    if(paletteFormat == gpufmt::Format::UNDEFINED) { return; }
+
+    // unpack 1, 2 and 4 bit indices to one index per byte
+    if(png_get_bit_depth(pngRead, pngInfo) < 8) { png_set_packing(pngRead); }
+
+    png_set_interlace_handling(pngRead);
+
+    png_read_update_info(pngRead, pngInfo);
+
+    const uint32_t width = png_get_image_width(pngRead, pngInfo);
+    const uint32_t height = png_get_image_height(pngRead, pngInfo);
+
+    cputex::TextureParams indexTextureParams{
+        .format = indexFormat,
+        .dimension = cputex::TextureDimension::Texture2D,
+        .extent = {width, height, 1},
+        .arraySize = 1,
+        .faces = 1,
+        .mips = 1
+    };
+
+    cputex::TextureParams paletteTextureParams{
+        .format = paletteFormat,
+        .dimension = cputex::TextureDimension::Texture1D,
+        .extent = {paletteSize, 1, 1},
+        .arraySize = 1,
+        .faces = 1,
+        .mips = 1
+    };
+
+    textureAllocator.preAllocation(2);
+
+    if(!textureAllocator.allocateTexture(indexTextureParams, 0))
+    {
+        setTextureAllocationError(indexTextureParams);
+        return;
+    }
+
+    if(!textureAllocator.allocateTexture(paletteTextureParams, 1))
+    {
+        setTextureAllocationError(paletteTextureParams);
+        return;
+    }
+
+    textureAllocator.postAllocation();
+
+    const bool bgr = isBgrFormat(paletteFormat);
+    std::span<png_byte> paletteSpan = castWritableBytes<png_byte>(textureAllocator.accessTextureData(1, {}));
+
+    for(int i = 0; i < paletteSize; ++i)
+    {
+        std::span<png_byte> entry = paletteSpan.subspan(i * 4, 4);
+
+        entry[0] = (bgr) ? palette[i].blue : palette[i].red;
+        entry[1] = palette[i].green;
+        entry[2] = (bgr) ? palette[i].red : palette[i].blue;
+        entry[3] = (i < transparencySize) ? transparency[i] : 0xFF;
+    }
+
+    std::span<std::byte> indexSpan = textureAllocator.accessTextureData(0, {});
+
+    std::vector<png_byte*> rows(height);
+    for(size_t row = 0; row < height; ++row)
+    {
+        rows[row] = castWritableBytes<png_byte>(indexSpan.subspan(row * width)).data();
+    }
+
+    png_read_image(pngRead, rows.data());
+}
 } // namespace teximp::png
 
 #endif // TEXIMP_ENABLE_PNG_BACKEND_LIBPNG
\ No newline at end of file
@@ -0,0 +1,307 @@
+#include <teximp/png/png_importer.spng.h>
+
+#ifdef TEXIMP_ENABLE_PNG_BACKEND_SPNG
+
+#include <spng.h>
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include <gsl/gsl-lite.hpp>
+
+namespace teximp::png
+{
+bool PngSpngImporter::checkSignature(std::istream& stream)
+{
+    if(!stream)
+    {
+        mStatus = TextureImportStatus::Error;
+        mError = TextureImportError::FailedToOpenFile;
+        return false;
+    }
+
+    constexpr std::array<uint8_t, 8> pngSignature = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::array<uint8_t, 8> fileSignature;
+
+    stream.read(reinterpret_cast<char*>(fileSignature.data()), fileSignature.size());
+
+    return !stream.fail() && fileSignature == pngSignature;
+}
+
+void PngSpngImporter::setErrorFromSpng(int errorCode)
+{
+    TextureImportError error = TextureImportError::InvalidDataInImage;
+
+    if(errorCode == SPNG_IO_EOF) { error = TextureImportError::NotEnoughData; }
+    else if(errorCode == SPNG_IO_ERROR) { error = TextureImportError::FailedToReadFile; }
+    else if(errorCode == SPNG_EWIDTH || errorCode == SPNG_EHEIGHT || errorCode == SPNG_EUSER_WIDTH ||
+            errorCode == SPNG_EUSER_HEIGHT)
+    {
+        error = TextureImportError::DimensionsTooLarge;
+    }
+
+    setError(error, spng_strerror(errorCode));
+}
+
+void PngSpngImporter::load(std::istream& stream, ITextureAllocator& textureAllocator, TextureImportOptions options)
+{
+    // libspng reads the signature itself
+    stream.seekg(0);
+
+    spng_ctx* context = spng_ctx_new((options.trustedSource) ? SPNG_CTX_IGNORE_ADLER32 : 0);
+
+    if(context == nullptr)
+    {
+        setError(TextureImportError::Unknown, "Failed to create the libspng context.");
+        return;
+    }
+
+    auto scopeCleanup = gsl::finally([context]() { spng_ctx_free(context); });
+
+    spng_set_png_stream(
+        context,
+        [](spng_ctx* /*context*/, void* user, void* data, size_t length)
+        {
+            std::istream& stream = *static_cast<std::istream*>(user);
+            stream.read(static_cast<char*>(data), length);
+
+            if(stream.gcount() != static_cast<std::streamsize>(length)) { return (int)SPNG_IO_EOF; }
+
+            return 0;
+        },
+        &stream);
+
+    if(options.trustedSource) { spng_set_crc_action(context, SPNG_CRC_USE, SPNG_CRC_USE); }
+
+    spng_set_image_limits(context, kMaxTextureWidth, kMaxTextureHeight);
+
+    spng_ihdr header;
+
+    if(int result = spng_get_ihdr(context, &header); result != 0)
+    {
+        setErrorFromSpng(result);
+        return;
+    }
+
+    spng_trns transparency;
+    const bool hasTransparency = spng_get_trns(context, &transparency) == 0;
+    const bool pngHasAlpha = hasAlpha(header.color_type, hasTransparency);
+
+    // same as the libpng importer, only images without an sRGB chunk are treated as sRGB
+    uint8_t renderingIntent;
+    const bool sRgb = spng_get_srgb(context, &renderingIntent) != 0;
+
+    if(header.color_type == SPNG_COLOR_TYPE_INDEXED && options.preservePalette)
+    {
+        readPalettizedImage(context, textureAllocator, header.width, header.height, header.bit_depth, sRgb);
+        return;
+    }
+
+    const bool alphaNeeded = pngHasAlpha || options.padRgbWithAlpha;
+
+    const gpufmt::Format gpuFormat = selectFormat(textureAllocator, header.bit_depth, alphaNeeded, sRgb);
+
+    if(gpuFormat == gpufmt::Format::UNDEFINED) { return; }
+
+    const size_t blockSize = gpufmt::formatInfo(gpuFormat).blockByteSize;
+
+    // 16 bit rgb has no libspng output format, it's decoded as rgba and the alpha is dropped afterwards
+    int decodeFormat = SPNG_FMT_RGBA8;
+
+    if(blockSize == 3) { decodeFormat = SPNG_FMT_RGB8; }
+    else if(blockSize == 6 || blockSize == 8) { decodeFormat = SPNG_FMT_RGBA16; }
+
+    size_t decodedByteSize = 0;
+
+    if(int result = spng_decoded_image_size(context, decodeFormat, &decodedByteSize); result != 0)
+    {
+        setErrorFromSpng(result);
+        return;
+    }
+
+    cputex::TextureParams textureParams{
+        .format = gpuFormat,
+        .dimension = cputex::TextureDimension::Texture2D,
+        .extent = {header.width, header.height, 1},
+        .arraySize = 1,
+        .faces = 1,
+        .mips = 1
+    };
+
+    textureAllocator.preAllocation(1);
+
+    if(!textureAllocator.allocateTexture(textureParams, 0))
+    {
+        setTextureAllocationError(textureParams);
+        return;
+    }
+
+    textureAllocator.postAllocation();
+
+    std::span<std::byte> surfaceSpan = textureAllocator.accessTextureData(0, {});
+
+    std::vector<std::byte> rgba16Buffer;
+    std::span<std::byte> decodeSpan = surfaceSpan;
+
+    if(blockSize == 6)
+    {
+        rgba16Buffer.resize(decodedByteSize);
+        decodeSpan = rgba16Buffer;
+    }
+
+    if(decodeSpan.size_bytes() < decodedByteSize)
+    {
+        setError(TextureImportError::Unknown, "Texture surface is too small for the decoded image.");
+        return;
+    }
+
+    if(int result = spng_decode_image(context, decodeSpan.data(), decodedByteSize, decodeFormat, SPNG_DECODE_TRNS);
+       result != 0)
+    {
+        setErrorFromSpng(result);
+        return;
+    }
+
+    const size_t pixelCount = size_t(header.width) * header.height;
+
+    if(blockSize == 6)
+    {
+        std::span<const uint16_t> rgba = castBytes<uint16_t>(rgba16Buffer);
+        std::span<uint16_t> rgb = castWritableBytes<uint16_t>(surfaceSpan);
+
+        for(size_t i = 0; i < pixelCount; ++i)
+        {
+            std::memcpy(&rgb[i * 3], &rgba[i * 4], sizeof(uint16_t) * 3);
+        }
+    }
+    else if(isBgrFormat(gpuFormat))
+    {
+        std::span<uint8_t> pixels = castWritableBytes<uint8_t>(surfaceSpan);
+
+        for(size_t i = 0; i < pixelCount; ++i)
+        {
+            std::swap(pixels[i * blockSize], pixels[i * blockSize + 2]);
+        }
+    }
+}
+
+void PngSpngImporter::readPalettizedImage(spng_ctx* context, ITextureAllocator& textureAllocator, uint32_t width,
+                                          uint32_t height, int bitDepth, bool sRgb)
+{
+    spng_plte palette;
+
+    if(spng_get_plte(context, &palette) != 0 || palette.n_entries == 0)
+    {
+        setError(TextureImportError::InvalidDataInImage, "Palettized png is missing its PLTE chunk.");
+        return;
+    }
+
+    spng_trns transparency;
+    const uint32_t transparencySize =
+        (spng_get_trns(context, &transparency) == 0) ? transparency.n_type3_entries : 0u;
+
+    const gpufmt::Format indexFormat = selectIndexFormat(textureAllocator);
+
+    if(indexFormat == gpufmt::Format::UNDEFINED) { return; }
+
+    const gpufmt::Format paletteFormat = selectPaletteFormat(textureAllocator, sRgb);
+
+    if(paletteFormat == gpufmt::Format::UNDEFINED) { return; }
+
+    // SPNG_FMT_PNG keeps the indices packed at their bit depth
+    size_t packedByteSize = 0;
+
+    if(int result = spng_decoded_image_size(context, SPNG_FMT_PNG, &packedByteSize); result != 0)
+    {
+        setErrorFromSpng(result);
+        return;
+    }
+
+    cputex::TextureParams indexTextureParams{
+        .format = indexFormat,
+        .dimension = cputex::TextureDimension::Texture2D,
+        .extent = {width, height, 1},
+        .arraySize = 1,
+        .faces = 1,
+        .mips = 1
+    };
+
+    cputex::TextureParams paletteTextureParams{
+        .format = paletteFormat,
+        .dimension = cputex::TextureDimension::Texture1D,
+        .extent = {palette.n_entries, 1, 1},
+        .arraySize = 1,
+        .faces = 1,
+        .mips = 1
+    };
+
+    textureAllocator.preAllocation(2);
+
+    if(!textureAllocator.allocateTexture(indexTextureParams, 0))
+    {
+        setTextureAllocationError(indexTextureParams);
+        return;
+    }
+
+    if(!textureAllocator.allocateTexture(paletteTextureParams, 1))
+    {
+        setTextureAllocationError(paletteTextureParams);
+        return;
+    }
+
+    textureAllocator.postAllocation();
+
+    const bool bgr = isBgrFormat(paletteFormat);
+    std::span<uint8_t> paletteSpan = castWritableBytes<uint8_t>(textureAllocator.accessTextureData(1, {}));
+
+    for(uint32_t i = 0; i < palette.n_entries; ++i)
+    {
+        std::span<uint8_t> entry = paletteSpan.subspan(i * 4, 4);
+
+        entry[0] = (bgr) ? palette.entries[i].blue : palette.entries[i].red;
+        entry[1] = palette.entries[i].green;
+        entry[2] = (bgr) ? palette.entries[i].red : palette.entries[i].blue;
+        entry[3] = (i < transparencySize) ? transparency.type3_alpha[i] : 0xFF;
+    }
+
+    std::span<uint8_t> indexSpan = castWritableBytes<uint8_t>(textureAllocator.accessTextureData(0, {}));
+
+    if(bitDepth == 8)
+    {
+        if(int result = spng_decode_image(context, indexSpan.data(), packedByteSize, SPNG_FMT_PNG, 0); result != 0)
+        {
+            setErrorFromSpng(result);
+        }
+
+        return;
+    }
+
+    std::vector<uint8_t> packedIndices(packedByteSize);
+
+    if(int result = spng_decode_image(context, packedIndices.data(), packedByteSize, SPNG_FMT_PNG, 0); result != 0)
+    {
+        setErrorFromSpng(result);
+        return;
+    }
+
+    // unpack 1, 2 and 4 bit indices to one index per byte
+    const size_t packedRowPitch = packedByteSize / height;
+    const int indicesPerByte = 8 / bitDepth;
+    const uint8_t indexMask = static_cast<uint8_t>((1 << bitDepth) - 1);
+
+    for(uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* packedRow = packedIndices.data() + y * packedRowPitch;
+        uint8_t* indexRow = indexSpan.data() + size_t(y) * width;
+
+        for(uint32_t x = 0; x < width; ++x)
+        {
+            const int shift = 8 - bitDepth * (1 + static_cast<int>(x % indicesPerByte));
+            indexRow[x] = (packedRow[x / indicesPerByte] >> shift) & indexMask;
+        }
+    }
+}
+} // namespace teximp::png
+
+#endif // TEXIMP_ENABLE_PNG_BACKEND_SPNG
@@ -1007,8 +1007,16 @@ void TargaTexImpImporter::load(std::istream& stream, ITextureAllocator& textureA
 
     if(mHeader.colorMapType == 1)
     {
-        mColorMapData.resize(mHeader.colorMap.length * (mHeader.colorMap.entrySize / 8));
-        stream.read((char*)(mColorMapData.data()), mColorMapData.size());
+        const size_t entryByteSize = (mHeader.colorMap.entrySize + 7) / 8;
+        const size_t colorMapByteSize = mHeader.colorMap.length * entryByteSize;
+
+        // Pad the color map to cover every value an index can hold. The pixel readers then never have to bounds check
+        // the indices they read.
+        const size_t indexRangeByteSize =
+            (isColorMap(mHeader.imageType)) ? (size_t(1) << mHeader.image.bitsPerPixel) * entryByteSize : 0;
+
+        mColorMapData.resize(std::max(colorMapByteSize, indexRangeByteSize));
+        stream.read((char*)(mColorMapData.data()), colorMapByteSize);
     }
 
     if(mHeader.imageType == 0)
@@ -1057,10 +1065,35 @@ void TargaTexImpImporter::load(std::istream& stream, ITextureAllocator& textureA
 
     if(selectedFormat == gpufmt::Format::UNDEFINED) { return; }
 
+    // thumbnails use the postage stamp when it covers them. It's stored uncompressed in the image's own pixel format,
+    // right after its 8 bit width and height.
+    std::array<uint8_t, 2> postageStampExtent{0, 0};
+    bool usePostageStamp = false;
+
+    if(options.thumbnailSize > 0 && mFooterFound && mExtensionHeader.postageStampOffset > 0)
+    {
+        const std::streampos imagePos = stream.tellg();
+        stream.seekg(mExtensionHeader.postageStampOffset, std::ios::beg);
+        stream.read((char*)postageStampExtent.data(), postageStampExtent.size());
+
+        usePostageStamp = !stream.fail() && postageStampExtent[0] > 0 && postageStampExtent[1] > 0 &&
+                          std::max(postageStampExtent[0], postageStampExtent[1]) >= options.thumbnailSize;
+
+        if(!usePostageStamp)
+        {
+            stream.clear();
+            stream.seekg(imagePos, std::ios::beg);
+        }
+    }
+
+    const cputex::Extent imageExtent = (usePostageStamp)
+                                           ? cputex::Extent{postageStampExtent[0], postageStampExtent[1], 1}
+                                           : cputex::Extent{mHeader.image.width, mHeader.image.height, 1};
+
     cputex::TextureParams textureParams{
         .format = selectedFormat,
         .dimension = cputex::TextureDimension::Texture2D,
-        .extent = {mHeader.image.width, mHeader.image.height, 1},
+        .extent = imageExtent,
         .arraySize = 1,
         .faces = 1,
         .mips = 1
@@ -1079,8 +1112,13 @@ void TargaTexImpImporter::load(std::istream& stream, ITextureAllocator& textureA
     cputex::SurfaceSpan surface(textureParams.format, textureParams.dimension, textureParams.extent,
                                 textureAllocator.accessTextureData(0, {}));
 
+    // the postage stamp of an RLE image isn't compressed
+    const uint8_t imageType = (usePostageStamp && isRLECompressed(mHeader.imageType))
+                                  ? static_cast<uint8_t>(mHeader.imageType - 8)
+                                  : mHeader.imageType;
+
     // read image
-    switch(mHeader.imageType)
+    switch(imageType)
     {
     case 1:
         // uncompressed color map
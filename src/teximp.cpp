@@ -1,12 +1,16 @@
+#include "memory_stream.h"
 #include "texture_importer_factory.h"
 
 #include <cputex/converter.h>
 #include <cputex/string.h>
+#include <glm/gtc/packing.hpp>
 #include <gpufmt/string.h>
 #include <teximp/string.h>
 #include <teximp/teximp.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <format>
 #include <fstream>
 #include <locale>
@@ -140,6 +144,34 @@ TextureImportResult importTexture(const std::filesystem::path& filePath, Texture
     return TextureImportResult{.importer = std::move(importer), .textureAllocator = std::move(textureAllocator)};
 }
 
+TextureImportResult importTexture(std::span<const std::byte> data, TextureImportOptions options,
+                                  PreferredBackends preferredBackends)
+{
+    DefaultTextureAllocator textureAllocator;
+    std::unique_ptr<TextureImporter> importer = importTexture(data, textureAllocator, options, preferredBackends);
+
+    return TextureImportResult{.importer = std::move(importer), .textureAllocator = std::move(textureAllocator)};
+}
+
+std::unique_ptr<TextureImporter> importTexture(std::span<const std::byte> data, ITextureAllocator& textureAllocator,
+                                               TextureImportOptions options, PreferredBackends preferredBackends)
+{
+    MemoryStream imageStream{data};
+
+    for(FileFormat fileFormat : supportedFileFormats())
+    {
+        auto importer = TextureImporterFactory::makeTextureImporter(fileFormat, textureAllocator, options,
+                                                                    preferredBackends, {}, imageStream, data);
+
+        if(importer) { return importer; }
+
+        imageStream.clear();
+        imageStream.seekg(0);
+    }
+
+    return std::make_unique<NullTextureImporter>(TextureImportError::UnknownFileFormat);
+}
+
 std::unique_ptr<TextureImporter> importTexture(const std::filesystem::path& filePath,
                                                ITextureAllocator& textureAllocator, TextureImportOptions options,
                                                PreferredBackends preferredBackends)
@@ -197,6 +229,252 @@ std::unique_ptr<TextureImporter> importTexture(const std::filesystem::path& file
     return importer;
 }
 
+enum class ThumbnailComponentType
+{
+    // sampled with the nearest pixel
+    Unfiltered,
+    UNorm8,
+    UNorm16,
+    SFloat16,
+    SFloat32
+};
+
+ThumbnailComponentType thumbnailComponentType(gpufmt::Format format)
+{
+    switch(format)
+    {
+    case gpufmt::Format::R16_UNORM:
+    case gpufmt::Format::R16G16_UNORM:
+    case gpufmt::Format::R16G16B16_UNORM:
+    case gpufmt::Format::R16G16B16A16_UNORM:
+        return ThumbnailComponentType::UNorm16;
+    case gpufmt::Format::R16_SFLOAT:
+    case gpufmt::Format::R16G16_SFLOAT:
+    case gpufmt::Format::R16G16B16_SFLOAT:
+    case gpufmt::Format::R16G16B16A16_SFLOAT:
+        return ThumbnailComponentType::SFloat16;
+    case gpufmt::Format::R32_SFLOAT:
+    case gpufmt::Format::R32G32_SFLOAT:
+    case gpufmt::Format::R32G32B32_SFLOAT:
+    case gpufmt::Format::R32G32B32A32_SFLOAT:
+        return ThumbnailComponentType::SFloat32;
+    default:
+        break;
+    }
+
+    const gpufmt::FormatInfo& formatInfo = gpufmt::formatInfo(format);
+
+    // 8 bit unsigned components, including srgb and packed orders like bgra
+    if(formatInfo.blockByteSize == formatInfo.componentCount && !formatInfo.isSigned)
+    {
+        return ThumbnailComponentType::UNorm8;
+    }
+
+    return ThumbnailComponentType::Unfiltered;
+}
+
+float loadThumbnailComponent(ThumbnailComponentType type, const std::byte* data)
+{
+    switch(type)
+    {
+    case ThumbnailComponentType::UNorm8:
+        return static_cast<float>(std::to_integer<uint8_t>(*data));
+    case ThumbnailComponentType::UNorm16:
+    {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return static_cast<float>(value);
+    }
+    case ThumbnailComponentType::SFloat16:
+    {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return glm::unpackHalf1x16(value);
+    }
+    case ThumbnailComponentType::SFloat32:
+    {
+        float value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    default:
+        return 0.0f;
+    }
+}
+
+void storeThumbnailComponent(ThumbnailComponentType type, float value, std::byte* data)
+{
+    switch(type)
+    {
+    case ThumbnailComponentType::UNorm8:
+        *data = static_cast<std::byte>(std::clamp(std::lround(value), 0l, 255l));
+        break;
+    case ThumbnailComponentType::UNorm16:
+    {
+        const uint16_t integerValue = static_cast<uint16_t>(std::clamp(std::lround(value), 0l, 65535l));
+        std::memcpy(data, &integerValue, sizeof(integerValue));
+        break;
+    }
+    case ThumbnailComponentType::SFloat16:
+    {
+        const uint16_t halfValue = glm::packHalf1x16(value);
+        std::memcpy(data, &halfValue, sizeof(halfValue));
+        break;
+    }
+    case ThumbnailComponentType::SFloat32:
+        std::memcpy(data, &value, sizeof(value));
+        break;
+    default:
+        break;
+    }
+}
+
+// Box filters the source surface down to the destination extent, every destination pixel averages the source pixels
+// it covers.
+void resampleThumbnail(std::span<const std::byte> source, glm::ivec2 sourceExtent, std::span<std::byte> destination,
+                       glm::ivec2 destinationExtent, gpufmt::Format format)
+{
+    const gpufmt::FormatInfo& formatInfo = gpufmt::formatInfo(format);
+    const ThumbnailComponentType componentType = thumbnailComponentType(format);
+    const size_t pixelByteSize = formatInfo.blockByteSize;
+    const size_t componentCount = formatInfo.componentCount;
+    const size_t componentByteSize = pixelByteSize / componentCount;
+
+    std::array<float, 4> sums;
+
+    for(int y = 0; y < destinationExtent.y; ++y)
+    {
+        const int firstRow = static_cast<int>(static_cast<int64_t>(y) * sourceExtent.y / destinationExtent.y);
+        const int lastRow = std::max(
+            firstRow + 1, static_cast<int>(static_cast<int64_t>(y + 1) * sourceExtent.y / destinationExtent.y));
+
+        for(int x = 0; x < destinationExtent.x; ++x)
+        {
+            const int firstColumn = static_cast<int>(static_cast<int64_t>(x) * sourceExtent.x / destinationExtent.x);
+            const int lastColumn = std::max(
+                firstColumn + 1, static_cast<int>(static_cast<int64_t>(x + 1) * sourceExtent.x / destinationExtent.x));
+
+            std::byte* destinationPixel =
+                destination.data() + (static_cast<size_t>(y) * destinationExtent.x + x) * pixelByteSize;
+
+            if(componentType == ThumbnailComponentType::Unfiltered)
+            {
+                const size_t sourceIndex = static_cast<size_t>((firstRow + lastRow) / 2) * sourceExtent.x +
+                                           static_cast<size_t>((firstColumn + lastColumn) / 2);
+                std::memcpy(destinationPixel, source.data() + sourceIndex * pixelByteSize, pixelByteSize);
+                continue;
+            }
+
+            sums.fill(0.0f);
+
+            for(int row = firstRow; row < lastRow; ++row)
+            {
+                const std::byte* sourcePixel =
+                    source.data() + (static_cast<size_t>(row) * sourceExtent.x + firstColumn) * pixelByteSize;
+
+                for(int column = firstColumn; column < lastColumn; ++column, sourcePixel += pixelByteSize)
+                {
+                    for(size_t component = 0; component < componentCount; ++component)
+                    {
+                        sums[component] +=
+                            loadThumbnailComponent(componentType, sourcePixel + component * componentByteSize);
+                    }
+                }
+            }
+
+            const float sampleCount = static_cast<float>((lastRow - firstRow) * (lastColumn - firstColumn));
+
+            for(size_t component = 0; component < componentCount; ++component)
+            {
+                storeThumbnailComponent(componentType, sums[component] / sampleCount,
+                                        destinationPixel + component * componentByteSize);
+            }
+        }
+    }
+}
+
+TextureImportResult importThumbnail(const std::filesystem::path& filePath, int maxDimension,
+                                    TextureImportOptions options, PreferredBackends preferredBackends)
+{
+    // only a single plain 2D texture is used
+    options.thumbnailSize = maxDimension;
+    options.preservePalette = false;
+    options.importAnimationFrames = false;
+    options.generateMips = false;
+    options.yuvPlanarOutput = false;
+    options.deferTileLoading = false;
+
+    TextureImportResult result = importTexture(filePath, options, preferredBackends);
+    std::span<const cputex::UniqueTexture> textures = result.textureAllocator.getTextures();
+
+    if(maxDimension <= 0 || result.importer->status() == TextureImportStatus::Error || textures.empty())
+    {
+        return result;
+    }
+
+    const cputex::UniqueTexture& texture = textures.front();
+
+    // smallest stored mip that still covers the thumbnail
+    int mip = 0;
+
+    for(int i = 1; i < static_cast<int>(texture.mips()); ++i)
+    {
+        const cputex::Extent& mipExtent = texture.extent(i);
+
+        if(std::max(mipExtent.x, mipExtent.y) < maxDimension) { break; }
+
+        mip = i;
+    }
+
+    const cputex::Extent& sourceExtent = texture.extent(mip);
+    const gpufmt::FormatInfo& formatInfo = gpufmt::formatInfo(texture.format());
+    const int largestSide = std::max(sourceExtent.x, sourceExtent.y);
+
+    cputex::TextureParams params;
+    params.format = texture.format();
+    params.dimension = cputex::TextureDimension::Texture2D;
+    params.extent = cputex::Extent{sourceExtent.x, sourceExtent.y, 1};
+    params.arraySize = 1;
+    params.faces = 1;
+    params.mips = 1;
+
+    // block compressed images aren't resampled
+    if(largestSide > maxDimension && !formatInfo.isCompressed())
+    {
+        const double scale = static_cast<double>(maxDimension) / largestSide;
+        params.extent.x = std::max(1, static_cast<int>(std::lround(sourceExtent.x * scale)));
+        params.extent.y = std::max(1, static_cast<int>(std::lround(sourceExtent.y * scale)));
+    }
+
+    DefaultTextureAllocator thumbnailAllocator;
+    thumbnailAllocator.preAllocation(1);
+
+    if(!thumbnailAllocator.allocateTexture(params, 0))
+    {
+        return TextureImportResult{.importer = std::make_unique<NullTextureImporter>(
+                                       TextureImportError::TextureAllocationFailed)};
+    }
+
+    thumbnailAllocator.postAllocation();
+
+    std::span<std::byte> destination = thumbnailAllocator.accessTextureData(0, {});
+    std::span<const std::byte> source = texture.getMipSurfaceData(0, 0, mip);
+
+    if(params.extent.x == sourceExtent.x && params.extent.y == sourceExtent.y)
+    {
+        // first depth slice of 3D textures
+        std::memcpy(destination.data(), source.data(), std::min(destination.size(), source.size()));
+    }
+    else
+    {
+        resampleThumbnail(source, {sourceExtent.x, sourceExtent.y}, destination, {params.extent.x, params.extent.y},
+                          texture.format());
+    }
+
+    return TextureImportResult{.importer = std::move(result.importer),
+                               .textureAllocator = std::move(thumbnailAllocator)};
+}
+
 TextureImporter::TextureImporter(std::filesystem::path filePath)
     : mFilePath(std::move(filePath))
 {}
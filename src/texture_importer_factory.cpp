@@ -6,9 +6,11 @@
 #include <teximp/bitmap/bitmap_importer.wic.h>
 #include <teximp/dds/dds_importer.teximp.h>
 #include <teximp/exr/exr_importer.openexr.h>
+#include <teximp/exr/exr_importer.openexr_core.h>
 #include <teximp/jpeg/jpeg_importer.libjpeg_turbo.h>
 #include <teximp/ktx/ktx_importer.teximp.h>
 #include <teximp/png/png_importer.libpng.h>
+#include <teximp/png/png_importer.spng.h>
 #include <teximp/targa/targa_importer.teximp.h>
 #include <teximp/tiff/tiff_importer.tiff.h>
 
@@ -55,6 +57,10 @@ namespace teximp
     case ExrImporterBackend::OpenExr: return std::make_unique<exr::ExrOpenExrImporter>();
 #endif
 
+#ifdef TEXIMP_ENABLE_EXR_BACKEND_OPENEXR_CORE
+    case ExrImporterBackend::OpenExrCore: return std::make_unique<exr::ExrOpenExrCoreImporter>();
+#endif
+
     default: return nullptr;
     }
 }
@@ -97,6 +103,10 @@ namespace teximp
     case PngImporterBackend::LibPng: return std::make_unique<png::PngLibPngImporter>();
 #endif
 
+#ifdef TEXIMP_ENABLE_PNG_BACKEND_SPNG
+    case PngImporterBackend::Spng: return std::make_unique<png::PngSpngImporter>();
+#endif
+
     default: return nullptr;
     }
 }
@@ -133,7 +143,8 @@ namespace teximp
 [[nodiscard]] std::unique_ptr<TextureImporter>
 TextureImporterFactory::makeTextureImporter(FileFormat fileFormat, ITextureAllocator& textureAllocator,
                                             TextureImportOptions options, PreferredBackends preferredBackends,
-                                            const std::filesystem::path& filePath, std::istream& stream)
+                                            const std::filesystem::path& filePath, std::istream& stream,
+                                            std::span<const std::byte> sourceData)
 {
     std::unique_ptr<TextureImporter> textureImporter;
 
@@ -176,6 +187,9 @@ TextureImporterFactory::makeTextureImporter(FileFormat fileFormat, ITextureAlloc
 
     if(!textureImporter) { return nullptr; }
 
+    textureImporter->mOptions = options;
+    textureImporter->mSourceData = sourceData;
+
     if(!textureImporter->checkSignature(stream)) { return nullptr; }
 
     textureImporter->mFilePath = filePath;
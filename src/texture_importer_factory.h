@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <filesystem>
 #include <istream>
 #include <memory>
+#include <span>
 
 namespace teximp
 {
@@ -18,6 +20,6 @@ public:
     static [[nodiscard]] std::unique_ptr<TextureImporter>
     makeTextureImporter(FileFormat fileFormat, ITextureAllocator& textureAllocator, TextureImportOptions options,
                         PreferredBackends preferredBackends, const std::filesystem::path& filePath,
-                        std::istream& stream);
+                        std::istream& stream, std::span<const std::byte> sourceData = {});
 };
 } // namespace teximp
\ No newline at end of file
@@ -2,7 +2,11 @@
 
 #ifdef TEXIMP_ENABLE_TIFF_BACKEND_TIFF
 
-#include <cputex/texture_operations.h>
+#include "cmyk_conversion.h"
+#include "memory_mapped_file.h"
+#include "memory_stream.h"
+#include "utilities.h"
+
 #include <glm/glm.hpp>
 #include <gpufmt/utility.h>
 #include <tiff.h>
@@ -11,6 +15,11 @@
 
 #include <gsl/gsl-lite.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
 namespace teximp::tiff
 {
 FileFormat TiffTexImpImporter::fileFormat() const
@@ -178,6 +187,8 @@ struct TiffClientData
     std::istream* stream = nullptr;
     std::ios::pos_type startPos{};
     TiffTexImpImporter* importer = nullptr;
+    // whole file in memory, libtiff decodes from it directly when it's set
+    std::span<const std::byte> data;
 };
 
 tmsize_t tiffRead(thandle_t fd, void* buf, tmsize_t size)
@@ -257,17 +268,21 @@ static int tiffDummyClose(thandle_t /*fd*/)
     return 0;
 }
 
-static int tiffDummyMap(thandle_t, void** base, toff_t* size)
+static int tiffMap(thandle_t fd, void** base, toff_t* size)
 {
-    (void)base;
-    (void)size;
-    return (0);
+    TiffClientData* data = reinterpret_cast<TiffClientData*>(fd);
+
+    // libtiff falls back to reading through the stream
+    if(data->data.empty()) { return 0; }
+
+    *base = const_cast<std::byte*>(data->data.data());
+    *size = static_cast<toff_t>(data->data.size());
+    return 1;
 }
 
-static void tiffDummyUnmap(thandle_t, void* base, toff_t size)
+static void tiffUnmap(thandle_t, void*, toff_t)
 {
-    (void)base;
-    (void)size;
+    // the memory is owned by the importer
 }
 
 TIFF* tiffStreamOpen(std::filesystem::path& filePath, TiffClientData& clientData)
@@ -275,8 +290,8 @@ TIFF* tiffStreamOpen(std::filesystem::path& filePath, TiffClientData& clientData
     clientData.startPos = clientData.stream->tellg();
 
     // Open for reading.
-    TIFF* tif = TIFFClientOpen(filePath.string().c_str(), "rm", reinterpret_cast<thandle_t>(&clientData), tiffRead,
-                               tiffDummyWrite, tiffSeek, tiffDummyClose, tiffSize, tiffDummyMap, tiffDummyUnmap);
+    TIFF* tif = TIFFClientOpen(filePath.string().c_str(), "r", reinterpret_cast<thandle_t>(&clientData), tiffRead,
+                               tiffDummyWrite, tiffSeek, tiffDummyClose, tiffSize, tiffMap, tiffUnmap);
 
     return tif;
 }
@@ -339,6 +354,214 @@ TextureParams createTextureParams(TIFF* tiffHandle, TextureImportOptions options
     return params;
 }
 
+struct TiffDirectory
+{
+    tdir_t index = 0;
+    // offset of one of the directory's SubIFDs, 0 for the directory itself
+    toff_t subDirectoryOffset = 0;
+};
+
+bool setTiffDirectory(TIFF* tiffHandle, const TiffDirectory& directory)
+{
+    if(TIFFSetDirectory(tiffHandle, directory.index) == 0) { return false; }
+
+    return directory.subDirectoryOffset == 0 || TIFFSetSubDirectory(tiffHandle, directory.subDirectoryOffset) != 0;
+}
+
+// Smallest reduced resolution image whose larger side is still at least thumbnailSize. Reduced images are looked for
+// in the top level directories and the SubIFDs of the first directory, the first directory is used when none fit.
+TiffDirectory selectThumbnailDirectory(TIFF* tiffHandle, int directoryCount, int thumbnailSize)
+{
+    TiffDirectory selectedDirectory;
+    uint32_t selectedSize = 0;
+
+    auto considerDirectory = [&](const TiffDirectory& directory)
+    {
+        uint32_t subfileType = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+
+        TIFFGetField(tiffHandle, TIFFTAG_SUBFILETYPE, &subfileType);
+        TIFFGetField(tiffHandle, TIFFTAG_IMAGEWIDTH, &width);
+        TIFFGetField(tiffHandle, TIFFTAG_IMAGELENGTH, &height);
+
+        const uint32_t size = std::max(width, height);
+
+        if(directory.index == 0 && directory.subDirectoryOffset == 0) { selectedSize = size; }
+        else if((subfileType & FILETYPE_REDUCEDIMAGE) != 0 && size >= static_cast<uint32_t>(thumbnailSize) &&
+                size < selectedSize)
+        {
+            selectedDirectory = directory;
+            selectedSize = size;
+        }
+    };
+
+    for(int i = 0; i < directoryCount; ++i)
+    {
+        const tdir_t index = static_cast<tdir_t>(i);
+
+        if(TIFFSetDirectory(tiffHandle, index) != 0) { considerDirectory({index, 0}); }
+    }
+
+    uint16_t subDirectoryCount = 0;
+    toff_t* subDirectoryOffsetsField = nullptr;
+
+    if(TIFFSetDirectory(tiffHandle, 0) != 0 &&
+       TIFFGetField(tiffHandle, TIFFTAG_SUBIFD, &subDirectoryCount, &subDirectoryOffsetsField) != 0)
+    {
+        // the field is freed when the directory changes
+        const std::vector<toff_t> subDirectoryOffsets(subDirectoryOffsetsField,
+                                                      subDirectoryOffsetsField + subDirectoryCount);
+
+        for(toff_t subDirectoryOffset : subDirectoryOffsets)
+        {
+            if(TIFFSetSubDirectory(tiffHandle, subDirectoryOffset) != 0) { considerDirectory({0, subDirectoryOffset}); }
+        }
+    }
+
+    return selectedDirectory;
+}
+
+bool isRgba8Format(gpufmt::Format format)
+{
+    return format == gpufmt::Format::R8G8B8A8_UNORM || format == gpufmt::Format::R8G8B8A8_SRGB;
+}
+
+struct TiffDecodeTarget
+{
+    TextureParams params;
+    std::span<std::byte> surface;
+    // decoded through libtiff's rgba interface, which converts every photometric interpretation to 8 bit rgba
+    bool rgbaInterface = false;
+    // cmyk pixels are converted to rgba as soon as their rows are in the surface, while they're still in cache
+    bool convertCmyk = false;
+};
+
+void convertCmykToRgba(gpufmt::Format format, std::span<std::byte> pixels)
+{
+    if(format == gpufmt::Format::R16G16B16A16_UNORM) { convertCmyk16ToRgba16(pixels); }
+    else { convertCmyk8ToRgba8(pixels); }
+}
+
+// Decodes tiles of the current directory until nextTile runs past the last one. Every tile is decoded into a single
+// tile sized buffer and its rows are copied straight to their place in the surface. Returns false when a tile fails.
+bool decodeTiles(TIFF* tiffHandle, const TiffDecodeTarget& target, glm::uvec2 tileSize, std::atomic<uint32_t>& nextTile)
+{
+    const TextureParams& params = target.params;
+    const size_t pixelByteSize = gpufmt::formatInfo(params.format).blockByteSize;
+    const uint32_t width = static_cast<uint32_t>(params.extent.x);
+    const uint32_t height = static_cast<uint32_t>(params.extent.y);
+    const uint32_t tilesAcross = (width + tileSize.x - 1) / tileSize.x;
+    const uint32_t tileCount = tilesAcross * ((height + tileSize.y - 1) / tileSize.y);
+
+    const size_t tileRowByteSize =
+        target.rgbaInterface ? tileSize.x * sizeof(uint32_t) : static_cast<size_t>(TIFFTileRowSize(tiffHandle));
+    std::vector<std::byte> tileBuffer(tileRowByteSize * tileSize.y);
+
+    for(uint32_t tile = nextTile++; tile < tileCount; tile = nextTile++)
+    {
+        const uint32_t x = (tile % tilesAcross) * tileSize.x;
+        const uint32_t y = (tile / tilesAcross) * tileSize.y;
+
+        const bool decoded =
+            target.rgbaInterface
+                ? TIFFReadRGBATile(tiffHandle, x, y, reinterpret_cast<uint32_t*>(tileBuffer.data())) != 0
+                : TIFFReadTile(tiffHandle, tileBuffer.data(), x, y, 0, 0) > 0;
+
+        if(!decoded) { return false; }
+
+        const uint32_t rows = std::min(tileSize.y, height - y);
+        const size_t rowByteSize = std::min<size_t>(std::min(tileSize.x, width - x) * pixelByteSize, tileRowByteSize);
+
+        for(uint32_t row = 0; row < rows; ++row)
+        {
+            // rgba tiles come out bottom up
+            const uint32_t tileRow = target.rgbaInterface ? tileSize.y - 1 - row : row;
+            std::byte* destination =
+                target.surface.data() + ((static_cast<size_t>(y) + row) * width + x) * pixelByteSize;
+
+            std::memcpy(destination, tileBuffer.data() + tileRow * tileRowByteSize, rowByteSize);
+
+            if(target.convertCmyk) { convertCmykToRgba(params.format, {destination, rowByteSize}); }
+        }
+    }
+
+    return true;
+}
+
+// Decodes strips of the current directory until nextStrip runs past the last one. Strips are decoded straight into
+// the surface when their rows have the surface's layout, otherwise through a single strip sized buffer. Returns false
+// when a strip fails.
+bool decodeStrips(TIFF* tiffHandle, const TiffDecodeTarget& target, uint32_t rowsPerStrip,
+                  std::atomic<uint32_t>& nextStrip)
+{
+    const TextureParams& params = target.params;
+    const uint32_t height = static_cast<uint32_t>(params.extent.y);
+    const uint32_t stripCount = (height + rowsPerStrip - 1) / rowsPerStrip;
+    const size_t surfaceRowByteSize = params.extent.x * gpufmt::formatInfo(params.format).blockByteSize;
+    const size_t scanlineSize = static_cast<size_t>(TIFFScanlineSize(tiffHandle));
+
+    std::vector<std::byte> stripBuffer;
+
+    if(scanlineSize != surfaceRowByteSize) { stripBuffer.resize(scanlineSize * rowsPerStrip); }
+
+    for(uint32_t strip = nextStrip++; strip < stripCount; strip = nextStrip++)
+    {
+        const uint32_t firstRow = strip * rowsPerStrip;
+        const uint32_t rows = std::min(rowsPerStrip, height - firstRow);
+        std::byte* destination = target.surface.data() + firstRow * surfaceRowByteSize;
+
+        if(stripBuffer.empty())
+        {
+            if(TIFFReadEncodedStrip(tiffHandle, strip, destination, rows * scanlineSize) < 0) { return false; }
+        }
+        else
+        {
+            if(TIFFReadEncodedStrip(tiffHandle, strip, stripBuffer.data(), rows * scanlineSize) < 0) { return false; }
+
+            for(uint32_t row = 0; row < rows; ++row)
+            {
+                std::memcpy(destination + row * surfaceRowByteSize, stripBuffer.data() + row * scanlineSize,
+                            std::min(scanlineSize, surfaceRowByteSize));
+            }
+        }
+
+        if(target.convertCmyk) { convertCmykToRgba(params.format, {destination, rows * surfaceRowByteSize}); }
+    }
+
+    return true;
+}
+
+// Runs decode on workerCount libtiff handles at once. libtiff handles can't be shared between threads, so every worker
+// opens its own handle over tiffData on the same directory. Without tiffData decode only runs on tiffHandle.
+template<class Decode>
+bool decodeOnWorkers(TIFF* tiffHandle, std::filesystem::path& filePath, std::span<const std::byte> tiffData,
+                     const TiffDirectory& directory, int workerCount, Decode&& decode)
+{
+    if(tiffData.empty() || workerCount <= 1) { return decode(tiffHandle); }
+
+    std::vector<char> workerSucceeded(workerCount, 0);
+
+    parallelFor(workerCount, workerCount,
+                [&](int worker)
+                {
+                    MemoryStream workerStream{tiffData};
+                    TiffClientData workerClientData;
+                    workerClientData.stream = &workerStream;
+                    workerClientData.data = tiffData;
+
+                    TIFF* workerHandle = tiffStreamOpen(filePath, workerClientData);
+
+                    if(workerHandle == nullptr) { return; }
+
+                    auto workerScopeExit = gsl::finally([workerHandle]() { TIFFClose(workerHandle); });
+
+                    workerSucceeded[worker] = setTiffDirectory(workerHandle, directory) && decode(workerHandle);
+                });
+
+    return std::find(workerSucceeded.begin(), workerSucceeded.end(), 0) == workerSucceeded.end();
+}
+
 void TiffTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAllocator, TextureImportOptions options)
 {
     stream.seekg(0);
@@ -353,15 +576,30 @@ void TiffTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAl
             errorMessage.assign(messagePrefix);
             vsprintf_s(errorMessage.data() + messagePrefix.size(), errorMessageSize + 1, fmt, args);
 
-            ((TiffClientData*)clientData)->importer->setErrorMessage(std::move(errorMessage));
+            // worker handles report their errors through their results instead
+            TiffTexImpImporter* importer = ((TiffClientData*)clientData)->importer;
+            if(importer != nullptr) { importer->setErrorMessage(std::move(errorMessage)); }
 #endif
         });
 
-    TIFFSetWarningHandler([](const char*, const char*, va_list) {});
+    if(options.trustedSource)
+    {
+        // without a handler libtiff doesn't even dispatch its warnings
+        TIFFSetWarningHandler(nullptr);
+    }
+    else { TIFFSetWarningHandler([](const char*, const char*, va_list) {}); }
+
+    // libtiff decodes straight from memory when the import came from a span or the file can be mapped. Strips and
+    // tiles are then also decoded in parallel through a libtiff handle per worker.
+    MemoryMappedFile mappedFile;
+    std::span<const std::byte> tiffData = mSourceData;
+
+    if(tiffData.empty() && !mFilePath.empty() && mappedFile.open(mFilePath)) { tiffData = mappedFile.data(); }
 
     TiffClientData tiffClientData;
     tiffClientData.stream = &stream;
     tiffClientData.importer = this;
+    tiffClientData.data = tiffData;
 
     TIFF* tiffHandle = tiffStreamOpen(mFilePath, tiffClientData);
 
@@ -373,13 +611,37 @@ void TiffTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAl
 
     auto scopeExit = gsl::finally([tiffHandle]() { TIFFClose(tiffHandle); });
 
+    const int threadCount = resolveThreadCount(options.threadCount);
+
     int numDirs = (int)TIFFNumberOfDirectories(tiffHandle);
 
+    // every directory is imported as its own texture, thumbnails only import the one closest to their size
+    std::vector<TiffDirectory> directories;
+
+    if(options.thumbnailSize > 0)
+    {
+        directories.emplace_back(selectThumbnailDirectory(tiffHandle, numDirs, options.thumbnailSize));
+        numDirs = 1;
+    }
+    else
+    {
+        for(int i = 0; i < numDirs; ++i)
+        {
+            directories.emplace_back(TiffDirectory{static_cast<tdir_t>(i), 0});
+        }
+    }
+
     textureAllocator.preAllocation((int)numDirs);
 
     for(int i = 0; i < numDirs; ++i)
     {
-        bool isCmyk;
+        if(!setTiffDirectory(tiffHandle, directories[i]))
+        {
+            setError(TextureImportError::InvalidDataInImage, "Could not read tiff directory.");
+            return;
+        }
+
+        bool isCmyk = false;
         cputex::TextureParams params = createTextureParams(tiffHandle, options, isCmyk);
 
         if(params.format == gpufmt::Format::UNDEFINED)
@@ -393,35 +655,36 @@ void TiffTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAl
             setTextureAllocationError(params);
             return;
         }
-
-        TIFFReadDirectory(tiffHandle);
     }
 
     textureAllocator.postAllocation();
 
-    TIFFSetDirectory(tiffHandle, 0);
-
     for(int i = 0; i < numDirs; ++i)
     {
-        bool isCmyk;
+        if(!setTiffDirectory(tiffHandle, directories[i]))
+        {
+            setError(TextureImportError::InvalidDataInImage, "Could not read tiff directory.");
+            return;
+        }
+
+        bool isCmyk = false;
         TextureParams params = createTextureParams(tiffHandle, options, isCmyk);
 
         std::span<std::byte> surfaceSpan = textureAllocator.accessTextureData(i, {});
 
-        uint32_t tileCount = TIFFNumberOfTiles(tiffHandle);
-
-        uint32_t tileWidth;
-        uint32_t tileHeight;
-
-        TIFFGetField(tiffHandle, TIFFTAG_TILEWIDTH, &tileWidth);
-        TIFFGetField(tiffHandle, TIFFTAG_TILELENGTH, &tileHeight);
+        uint16_t planarConfig = PLANARCONFIG_CONTIG;
+        TIFFGetFieldDefaulted(tiffHandle, TIFFTAG_PLANARCONFIG, &planarConfig);
 
-        tileCount = glm::min(TIFFNumberOfTiles(tiffHandle),
-                             ((2 * params.extent.x - 1) / tileWidth) * ((2 * params.extent.y - 1) / tileHeight));
+        // contiguous 8 bit cmyk is decoded raw and converted by the cmyk kernels instead of libtiff's rgba interface
+        TiffDecodeTarget target;
+        target.params = params;
+        target.surface = surfaceSpan;
+        target.rgbaInterface = isRgba8Format(params.format) && !(isCmyk && planarConfig == PLANARCONFIG_CONTIG);
+        target.convertCmyk = isCmyk && !target.rgbaInterface;
 
-        if(tileCount <= 1)
+        if(TIFFIsTiled(tiffHandle) == 0)
         {
-            if(params.format == gpufmt::Format::R8G8B8A8_UNORM || params.format == gpufmt::Format::R8G8B8A8_SRGB)
+            if(target.rgbaInterface)
             {
                 int ret =
                     TIFFReadRGBAImageOriented(tiffHandle, params.extent.x, params.extent.y,
@@ -434,91 +697,50 @@ void TiffTexImpImporter::load(std::istream& stream, ITextureAllocator& textureAl
             }
             else
             {
-                tmsize_t scanlineSize = TIFFScanlineSize(tiffHandle);
+                uint32_t rowsPerStrip = 0;
+                TIFFGetFieldDefaulted(tiffHandle, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+                rowsPerStrip = std::clamp(rowsPerStrip, 1u, static_cast<uint32_t>(params.extent.y));
 
-                for(int row = params.extent.y - 1; row >= 0; --row)
+                const uint32_t stripCount = (params.extent.y + rowsPerStrip - 1) / rowsPerStrip;
+                const int workerCount = std::min(threadCount, static_cast<int>(stripCount));
+                std::atomic<uint32_t> nextStrip{0};
+
+                if(!decodeOnWorkers(tiffHandle, mFilePath, tiffData, directories[i], workerCount,
+                                    [&](TIFF* handle)
+                                    { return decodeStrips(handle, target, rowsPerStrip, nextStrip); }))
                 {
-                    TIFFReadScanline(tiffHandle, surfaceSpan.subspan(row * scanlineSize).data(), row);
+                    setError(TextureImportError::Unknown, "Failed to read stripped image.");
+                    return;
                 }
             }
         }
         else
         {
-            cputex::TextureParams tileParams;
-            tileParams.dimension = cputex::TextureDimension::Texture2D;
-            tileParams.extent = {tileWidth, tileHeight, 1};
-            tileParams.arraySize = 1u;
-            tileParams.faces = 1u;
-            tileParams.mips = 1u;
-            tileParams.format = params.format;
+            uint32_t tileWidth = 0;
+            uint32_t tileHeight = 0;
 
-            cputex::UniqueTexture tileTexture(tileParams);
+            TIFFGetField(tiffHandle, TIFFTAG_TILEWIDTH, &tileWidth);
+            TIFFGetField(tiffHandle, TIFFTAG_TILELENGTH, &tileHeight);
 
-            cputex::SurfaceSpan destSurface(params.format, cputex::TextureDimension::Texture2D, params.extent,
-                                            surfaceSpan);
-
-            size_t tileIndex = 0;
-            for(cputex::ExtentComponent y = 0; y < params.extent.y; y += tileHeight)
+            if(tileWidth == 0 || tileHeight == 0)
             {
-                for(cputex::ExtentComponent x = 0; x < params.extent.x; x += tileWidth)
-                {
-                    tmsize_t bytesDecoded;
-                    if(params.format == gpufmt::Format::R8G8B8A8_UNORM ||
-                       params.format == gpufmt::Format::R8G8B8A8_SRGB)
-                    {
-                        bytesDecoded =
-                            TIFFReadRGBATile(tiffHandle, x, y, tileTexture.accessMipSurfaceDataAs<uint32_t>().data());
-                    }
-                    else
-                    {
-                        bytesDecoded =
-                            TIFFReadTile(tiffHandle, tileTexture.accessMipSurfaceDataAs<uint32_t>().data(), x, y, 0, 0);
-                    }
-
-                    if(bytesDecoded <= 0)
-                    {
-                        setError(TextureImportError::Unknown, "Failed to read tiled image.");
-                        return;
-                    }
-
-                    cputex::Extent destSize{glm::min((cputex::ExtentComponent)tileWidth, params.extent.x - x),
-                                            glm::min((cputex::ExtentComponent)tileHeight, params.extent.y - y),
-                                            cputex::ExtentComponent(1)};
-                    cputex::Extent destOffset(x, y, 0);
-
-                    cputex::flipHorizontal(static_cast<cputex::TextureSpan>(tileTexture));
-                    cputex::copySurfaceRegionTo((cputex::SurfaceView)tileTexture.getMipSurface(0, 0, 0),
-                                                cputex::Extent{0, 0, 0}, destSurface, destOffset, destSize);
-
-                    ++tileIndex;
-                }
+                setError(TextureImportError::InvalidDataInImage, "Tiled image has a tile width or height of 0.");
+                return;
             }
-        }
 
-        if(isCmyk && params.format == gpufmt::Format::R16G16B16A16_UNORM)
-        {
-            cputex::SurfaceSpan surface(params.format, cputex::TextureDimension::Texture2D, params.extent, surfaceSpan);
-            cputex::transform(surface,
-                              [](gpufmt::Format /*format*/, std::span<std::byte> block)
-                              {
-                                  const auto cmyk16 = castWritableBytes<glm::u16vec4>(block).front();
-                                  auto& rgba16 = castWritableBytes<glm::u16vec4>(block).front();
-
-                                  constexpr uint16_t unorm16Max = std::numeric_limits<uint16_t>::max();
-                                  constexpr float unorm16Maxf = static_cast<float>(unorm16Max);
-                                  constexpr float invUnorm16Max = 1.0f / unorm16Maxf;
-
-                                  const glm::vec4 cmyk(cmyk16.x * invUnorm16Max, cmyk16.y * invUnorm16Max,
-                                                       cmyk16.z * invUnorm16Max, cmyk16.w * invUnorm16Max);
-
-                                  rgba16.r = (uint16_t)std::round(unorm16Maxf * ((1.0f - cmyk.x) * (1.0f - cmyk.w)));
-                                  rgba16.g = (uint16_t)std::round(unorm16Maxf * ((1.0f - cmyk.y) * (1.0f - cmyk.w)));
-                                  rgba16.b = (uint16_t)std::round(unorm16Maxf * ((1.0f - cmyk.z) * (1.0f - cmyk.w)));
-                                  rgba16.a = unorm16Max;
-                              });
-        }
+            const glm::uvec2 tileSize{tileWidth, tileHeight};
+            const uint32_t tileCount = ((params.extent.x + tileWidth - 1) / tileWidth) *
+                                       ((params.extent.y + tileHeight - 1) / tileHeight);
+            const int workerCount = std::min(threadCount, static_cast<int>(tileCount));
+            std::atomic<uint32_t> nextTile{0};
 
-        TIFFReadDirectory(tiffHandle);
+            if(!decodeOnWorkers(tiffHandle, mFilePath, tiffData, directories[i], workerCount,
+                                [&](TIFF* handle) { return decodeTiles(handle, target, tileSize, nextTile); }))
+            {
+                setError(TextureImportError::Unknown, "Failed to read tiled image.");
+                return;
+            }
+        }
     }
 }
 } // namespace teximp::tiff
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 namespace teximp
 {
@@ -72,4 +76,65 @@ template<class EnumT>
     return (static_cast<std::underlying_type_t<EnumT>>(mask) & static_cast<std::underlying_type_t<EnumT>>(value)) !=
            std::underlying_type_t<EnumT>(0);
 }
+
+[[nodiscard]] inline int resolveThreadCount(int requestedThreadCount) noexcept
+{
+    if(requestedThreadCount > 0) { return requestedThreadCount; }
+
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Number of times an image can be halved, up to levelCount - 1 times, while its larger side stays at least minSize.
+// Importers use it to pick the smallest level that still covers TextureImportOptions::thumbnailSize.
+[[nodiscard]] inline int calculateThumbnailLevel(int width, int height, int minSize, int levelCount) noexcept
+{
+    if(minSize <= 0) { return 0; }
+
+    int level = 0;
+
+    while(level + 1 < levelCount && std::max(width >> (level + 1), height >> (level + 1)) >= minSize)
+    {
+        ++level;
+    }
+
+    return level;
+}
+
+// Calls func(index) for every index in [0, count) spread over at most threadCount threads, including the calling
+// thread. func must not throw.
+template<class Func>
+void parallelFor(int count, int threadCount, Func&& func)
+{
+    threadCount = std::min(threadCount, count);
+
+    if(threadCount <= 1)
+    {
+        for(int i = 0; i < count; ++i)
+        {
+            func(i);
+        }
+
+        return;
+    }
+
+    std::atomic<int> nextIndex{0};
+
+    auto worker = [&]()
+    {
+        for(int i = nextIndex++; i < count; i = nextIndex++)
+        {
+            func(i);
+        }
+    };
+
+    std::vector<std::jthread> threads;
+    threads.reserve(threadCount - 1);
+
+    for(int i = 0; i < threadCount - 1; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+
+    worker();
+}
 } // namespace teximp
\ No newline at end of file